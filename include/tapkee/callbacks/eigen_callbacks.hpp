@@ -6,6 +6,10 @@
 #ifndef TAPKEE_EIGEN_CALLBACKS_H_
 #define TAPKEE_EIGEN_CALLBACKS_H_
 
+/* Tapkee includes */
+#include <tapkee/utils/distance.hpp>
+/* End of Tapkee includes */
+
 namespace tapkee
 {
 	// Features callback that provides operation that 
@@ -54,6 +58,12 @@ namespace tapkee
 		{
 			return (feature_matrix.col(a)-feature_matrix.col(b)).norm();
 		}
+		// Returns distance or any value larger than
+		// the bound if the distance exceeds it.
+		inline tapkee::ScalarType distance_bounded(tapkee::IndexType a, tapkee::IndexType b, tapkee::ScalarType bound) const
+		{
+			return tapkee::tapkee_internal::bounded_euclidean_distance(feature_matrix.col(a),feature_matrix.col(b),bound);
+		}
 		inline tapkee::ScalarType operator()(tapkee::IndexType a, tapkee::IndexType b) const
 		{
 			return distance(a,b);
@@ -61,6 +71,133 @@ namespace tapkee
 		const tapkee::DenseMatrix& feature_matrix;
 };
 
+
+	namespace tapkee_internal
+	{
+		// Type the matrix is stored as in callbacks: 
+		// views (maps and refs) are cheap to copy and 
+		// stored by value, any other matrix by reference.
+		template <class MatrixType>
+		struct stored_matrix
+		{
+			typedef const MatrixType& type;
+		};
+		template <class PlainObjectType, int MapOptions, class StrideType>
+		struct stored_matrix<Eigen::Map<PlainObjectType,MapOptions,StrideType> >
+		{
+			typedef Eigen::Map<PlainObjectType,MapOptions,StrideType> type;
+		};
+#if EIGEN_VERSION_AT_LEAST(3,2,0)
+		template <class PlainObjectType, int RefOptions, class StrideType>
+		struct stored_matrix<Eigen::Ref<PlainObjectType,RefOptions,StrideType> >
+		{
+			typedef Eigen::Ref<PlainObjectType,RefOptions,StrideType> type;
+		};
+#endif
+
+		// Accessor of feature vectors stored either in 
+		// columns or in rows of the matrix. Both return
+		// blocks of the matrix so no copies are made and 
+		// contiguous vectors are processed vectorized.
+		template <class MatrixType, bool in_rows>
+		struct vectors_accessor
+		{
+			typedef typename MatrixType::ConstColXpr VectorType;
+			static inline VectorType vector(const MatrixType& matrix, IndexType i)
+			{
+				return matrix.col(i);
+			}
+			static inline void copy(const MatrixType& matrix, IndexType i, DenseVector& v)
+			{
+				v = matrix.col(i);
+			}
+			static inline IndexType dimension(const MatrixType& matrix)
+			{
+				return matrix.rows();
+			}
+		};
+		template <class MatrixType>
+		struct vectors_accessor<MatrixType,true>
+		{
+			typedef typename MatrixType::ConstRowXpr VectorType;
+			static inline VectorType vector(const MatrixType& matrix, IndexType i)
+			{
+				return matrix.row(i);
+			}
+			static inline void copy(const MatrixType& matrix, IndexType i, DenseVector& v)
+			{
+				v = matrix.row(i).transpose();
+			}
+			static inline IndexType dimension(const MatrixType& matrix)
+			{
+				return matrix.cols();
+			}
+		};
+	}
+
+	// Features callback over any Eigen matrix (e.g. DenseMatrix,
+	// row-major matrix, Eigen::Map or Eigen::Ref with arbitrary 
+	// strides) that stores feature vectors in columns or, if 
+	// in_rows is true, in rows. The data is used in place.
+	template <class MatrixType, bool in_rows=false>
+	struct eigen_matrix_features_callback
+	{
+		typedef tapkee_internal::vectors_accessor<MatrixType,in_rows> accessor;
+		eigen_matrix_features_callback(const MatrixType& matrix) : feature_matrix(matrix) {};
+		inline tapkee::IndexType dimension() const
+		{
+			return accessor::dimension(feature_matrix);
+		}
+		inline void vector(tapkee::IndexType i, tapkee::DenseVector& v) const
+		{
+			accessor::copy(feature_matrix,i,v);
+		}
+		typename tapkee_internal::stored_matrix<MatrixType>::type feature_matrix;
+	};
+
+	// Linear kernel callback over any Eigen matrix that stores
+	// feature vectors in columns or, if in_rows is true, in rows.
+	template <class MatrixType, bool in_rows=false>
+	struct eigen_matrix_kernel_callback
+	{
+		typedef tapkee_internal::vectors_accessor<MatrixType,in_rows> accessor;
+		eigen_matrix_kernel_callback(const MatrixType& matrix) : feature_matrix(matrix) {};
+		inline tapkee::ScalarType kernel(tapkee::IndexType a, tapkee::IndexType b) const
+		{
+			return accessor::vector(feature_matrix,a).dot(accessor::vector(feature_matrix,b));
+		}
+		inline tapkee::ScalarType operator()(tapkee::IndexType a, tapkee::IndexType b) const
+		{
+			return kernel(a,b);
+		}
+		typename tapkee_internal::stored_matrix<MatrixType>::type feature_matrix;
+	};
+
+	// Euclidean distance callback over any Eigen matrix that stores
+	// feature vectors in columns or, if in_rows is true, in rows.
+	template <class MatrixType, bool in_rows=false>
+	struct eigen_matrix_distance_callback
+	{
+		typedef tapkee_internal::vectors_accessor<MatrixType,in_rows> accessor;
+		eigen_matrix_distance_callback(const MatrixType& matrix) : feature_matrix(matrix) {};
+		inline tapkee::ScalarType distance(tapkee::IndexType a, tapkee::IndexType b) const
+		{
+			return (accessor::vector(feature_matrix,a)-accessor::vector(feature_matrix,b)).norm();
+		}
+		// Returns distance or any value larger than
+		// the bound if the distance exceeds it.
+		inline tapkee::ScalarType distance_bounded(tapkee::IndexType a, tapkee::IndexType b, tapkee::ScalarType bound) const
+		{
+			return tapkee::tapkee_internal::bounded_euclidean_distance(
+				accessor::vector(feature_matrix,a),accessor::vector(feature_matrix,b),bound);
+		}
+		inline tapkee::ScalarType operator()(tapkee::IndexType a, tapkee::IndexType b) const
+		{
+			return distance(a,b);
+		}
+		typename tapkee_internal::stored_matrix<MatrixType>::type feature_matrix;
+	};
+
 }
 
 #endif
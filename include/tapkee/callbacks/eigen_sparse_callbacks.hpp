@@ -0,0 +1,119 @@
+/* This software is distributed under BSD 3-clause license (see LICENSE file).
+ *
+ * Copyright (c) 2012-2013 Sergey Lisitsyn, Fernando Iglesias
+ */
+
+#ifndef TAPKEE_EIGEN_SPARSE_CALLBACKS_H_
+#define TAPKEE_EIGEN_SPARSE_CALLBACKS_H_
+
+/* Tapkee includes */
+#include <tapkee/defines.hpp>
+/* End of Tapkee includes */
+
+#include <cmath>
+#include <limits>
+
+namespace tapkee
+{
+	namespace tapkee_internal
+	{
+		// Returns squared euclidean distance between two columns
+		// of the sparse matrix or a partial sum larger than the
+		// bound once it is exceeded. Non-zero entries of both
+		// columns are merged so only O(nnz) operations are done.
+		inline tapkee::ScalarType bounded_squared_sparse_distance(const tapkee::SparseMatrix& matrix,
+		                                                         tapkee::IndexType a, tapkee::IndexType b,
+		                                                         tapkee::ScalarType squared_bound)
+		{
+			tapkee::SparseMatrix::InnerIterator it_a(matrix,a);
+			tapkee::SparseMatrix::InnerIterator it_b(matrix,b);
+			tapkee::ScalarType sum = 0.0;
+			while (it_a && it_b)
+			{
+				tapkee::ScalarType difference;
+				if (it_a.index() == it_b.index())
+				{
+					difference = it_a.value() - it_b.value();
+					++it_a;
+					++it_b;
+				}
+				else if (it_a.index() < it_b.index())
+				{
+					difference = it_a.value();
+					++it_a;
+				}
+				else
+				{
+					difference = it_b.value();
+					++it_b;
+				}
+				sum += difference*difference;
+				if (sum > squared_bound)
+					return sum;
+			}
+			for (; it_a; ++it_a)
+				sum += it_a.value()*it_a.value();
+			for (; it_b; ++it_b)
+				sum += it_b.value()*it_b.value();
+			return sum;
+		}
+	}
+
+	// Features callback over the sparse matrix that stores
+	// feature vectors in columns. Only the requested vector
+	// is made dense.
+	struct eigen_sparse_features_callback
+	{
+		eigen_sparse_features_callback(const tapkee::SparseMatrix& matrix) : feature_matrix(matrix) {};
+		inline tapkee::IndexType dimension() const
+		{
+			return feature_matrix.rows();
+		}
+		inline void vector(tapkee::IndexType i, tapkee::DenseVector& v) const
+		{
+			v = feature_matrix.col(i);
+		}
+		const tapkee::SparseMatrix& feature_matrix;
+	};
+
+	// Linear kernel callback over the sparse matrix that
+	// stores feature vectors in columns.
+	struct eigen_sparse_kernel_callback
+	{
+		eigen_sparse_kernel_callback(const tapkee::SparseMatrix& matrix) : feature_matrix(matrix) {};
+		inline tapkee::ScalarType kernel(tapkee::IndexType a, tapkee::IndexType b) const
+		{
+			return feature_matrix.col(a).dot(feature_matrix.col(b));
+		}
+		inline tapkee::ScalarType operator()(tapkee::IndexType a, tapkee::IndexType b) const
+		{
+			return kernel(a,b);
+		}
+		const tapkee::SparseMatrix& feature_matrix;
+	};
+
+	// Euclidean distance callback over the sparse matrix
+	// that stores feature vectors in columns.
+	struct eigen_sparse_distance_callback
+	{
+		eigen_sparse_distance_callback(const tapkee::SparseMatrix& matrix) : feature_matrix(matrix) {};
+		inline tapkee::ScalarType distance(tapkee::IndexType a, tapkee::IndexType b) const
+		{
+			return std::sqrt(tapkee_internal::bounded_squared_sparse_distance(feature_matrix,a,b,
+				std::numeric_limits<tapkee::ScalarType>::max()));
+		}
+		// Returns distance or any value larger than
+		// the bound if the distance exceeds it.
+		inline tapkee::ScalarType distance_bounded(tapkee::IndexType a, tapkee::IndexType b, tapkee::ScalarType bound) const
+		{
+			return std::sqrt(tapkee_internal::bounded_squared_sparse_distance(feature_matrix,a,b,bound*bound));
+		}
+		inline tapkee::ScalarType operator()(tapkee::IndexType a, tapkee::IndexType b) const
+		{
+			return distance(a,b);
+		}
+		const tapkee::SparseMatrix& feature_matrix;
+	};
+}
+
+#endif
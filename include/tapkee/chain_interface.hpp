@@ -10,6 +10,7 @@
 #include <tapkee/embed.hpp>
 #include <tapkee/callbacks/dummy_callbacks.hpp>
 #include <tapkee/callbacks/eigen_callbacks.hpp>
+#include <tapkee/callbacks/eigen_sparse_callbacks.hpp>
 /* End of Tapkee includes */
 
 namespace tapkee
@@ -47,6 +48,35 @@ namespace tapkee_internal
 		{
 			return embedRange(container.begin(),container.end());
 		}
+
+		/** Constructs an embedding using the data represented by the 
+		 * begin and end iterators and writes it to the provided matrix.
+		 *
+		 * @param begin an iterator that points to the beginning of data container
+		 * @param end an iterator that points to the end of data container
+		 * @param embedding a writable matrix (e.g. Eigen::Map or Eigen::Ref of 
+		 *                  any storage order) with a row per vector
+		 */
+		template<class RandomAccessIterator, class EmbeddingMatrix>
+		ProjectingFunction embedRange(RandomAccessIterator begin, RandomAccessIterator end,
+		                              const Eigen::MatrixBase<EmbeddingMatrix>& embedding) const
+		{
+			return tapkee::embed(begin,end,kernel,distance,features,parameters,embedding);
+		}
+
+		/** Constructs an embedding using the data represented by the container
+		 * and writes it to the provided matrix.
+		 *
+		 * @param container a container that supports begin() and end() methods 
+		 *                  to get corresponding iterators
+		 * @param embedding a writable matrix (e.g. Eigen::Map or Eigen::Ref of 
+		 *                  any storage order) with a row per vector
+		 */
+		template<class Container, class EmbeddingMatrix>
+		ProjectingFunction embedUsing(const Container& container, const Eigen::MatrixBase<EmbeddingMatrix>& embedding) const
+		{
+			return embedRange(container.begin(),container.end(),embedding);
+		}
 	private:
 		ParametersSet parameters;
 		KernelCallback kernel;
@@ -95,6 +125,36 @@ namespace tapkee_internal
 		{
 			return embedRange(container.begin(),container.end());
 		}
+
+		/** Constructs an embedding using the data represented by the 
+		 * begin and end iterators and writes it to the provided matrix.
+		 *
+		 * @param begin an iterator that points to the beginning of data container
+		 * @param end an iterator that points to the end of data container
+		 * @param embedding a writable matrix (e.g. Eigen::Map or Eigen::Ref of 
+		 *                  any storage order) with a row per vector
+		 */
+		template<class RandomAccessIterator, class EmbeddingMatrix>
+		ProjectingFunction embedRange(RandomAccessIterator begin, RandomAccessIterator end,
+		                              const Eigen::MatrixBase<EmbeddingMatrix>& embedding) const
+		{
+			return (*this).withFeatures(dummy_features_callback<typename RandomAccessIterator::value_type>())
+						  .embedRange(begin,end,embedding);
+		}
+
+		/** Constructs an embedding using the data represented by the container
+		 * and writes it to the provided matrix.
+		 *
+		 * @param container a container that supports begin() and end() methods 
+		 *                  to get corresponding iterators
+		 * @param embedding a writable matrix (e.g. Eigen::Map or Eigen::Ref of 
+		 *                  any storage order) with a row per vector
+		 */
+		template<class Container, class EmbeddingMatrix>
+		ProjectingFunction embedUsing(const Container& container, const Eigen::MatrixBase<EmbeddingMatrix>& embedding) const
+		{
+			return embedRange(container.begin(),container.end(),embedding);
+		}
 	private:
 		ParametersSet parameters;
 		KernelCallback kernel;
@@ -142,6 +202,36 @@ namespace tapkee_internal
 		{
 			return embedRange(container.begin(),container.end());
 		}
+
+		/** Constructs an embedding using the data represented by the 
+		 * begin and end iterators and writes it to the provided matrix.
+		 *
+		 * @param begin an iterator that points to the beginning of data container
+		 * @param end an iterator that points to the end of data container
+		 * @param embedding a writable matrix (e.g. Eigen::Map or Eigen::Ref of 
+		 *                  any storage order) with a row per vector
+		 */
+		template<class RandomAccessIterator, class EmbeddingMatrix>
+		ProjectingFunction embedRange(RandomAccessIterator begin, RandomAccessIterator end,
+		                              const Eigen::MatrixBase<EmbeddingMatrix>& embedding) const
+		{
+			return (*this).withDistance(dummy_distance_callback<typename RandomAccessIterator::value_type>())
+						  .embedRange(begin,end,embedding);
+		}
+
+		/** Constructs an embedding using the data represented by the container
+		 * and writes it to the provided matrix.
+		 *
+		 * @param container a container that supports begin() and end() methods 
+		 *                  to get corresponding iterators
+		 * @param embedding a writable matrix (e.g. Eigen::Map or Eigen::Ref of 
+		 *                  any storage order) with a row per vector
+		 */
+		template<class Container, class EmbeddingMatrix>
+		ProjectingFunction embedUsing(const Container& container, const Eigen::MatrixBase<EmbeddingMatrix>& embedding) const
+		{
+			return embedRange(container.begin(),container.end(),embedding);
+		}
 	private:
 		ParametersSet parameters;
 		KernelCallback kernel;
@@ -194,6 +284,36 @@ namespace tapkee_internal
 		{
 			return embedRange(container.begin(),container.end());
 		}
+
+		/** Constructs an embedding using the data represented by the 
+		 * begin and end iterators and writes it to the provided matrix.
+		 *
+		 * @param begin an iterator that points to the beginning of data container
+		 * @param end an iterator that points to the end of data container
+		 * @param embedding a writable matrix (e.g. Eigen::Map or Eigen::Ref of 
+		 *                  any storage order) with a row per vector
+		 */
+		template<class RandomAccessIterator, class EmbeddingMatrix>
+		ProjectingFunction embedRange(RandomAccessIterator begin, RandomAccessIterator end,
+		                              const Eigen::MatrixBase<EmbeddingMatrix>& embedding) const
+		{
+			return (*this).withKernel(dummy_kernel_callback<typename RandomAccessIterator::value_type>())
+						  .embedRange(begin,end,embedding);
+		}
+
+		/** Constructs an embedding using the data represented by the container
+		 * and writes it to the provided matrix.
+		 *
+		 * @param container a container that supports begin() and end() methods 
+		 *                  to get corresponding iterators
+		 * @param embedding a writable matrix (e.g. Eigen::Map or Eigen::Ref of 
+		 *                  any storage order) with a row per vector
+		 */
+		template<class Container, class EmbeddingMatrix>
+		ProjectingFunction embedUsing(const Container& container, const Eigen::MatrixBase<EmbeddingMatrix>& embedding) const
+		{
+			return embedRange(container.begin(),container.end(),embedding);
+		}
 	private:
 		ParametersSet parameters;
 		DistanceCallback distance;
@@ -253,6 +373,37 @@ namespace tapkee_internal
 		{
 			return embedRange(container.begin(),container.end());
 		}
+
+		/** Constructs an embedding using the data represented by the 
+		 * begin and end iterators and writes it to the provided matrix.
+		 *
+		 * @param begin an iterator that points to the beginning of data container
+		 * @param end an iterator that points to the end of data container
+		 * @param embedding a writable matrix (e.g. Eigen::Map or Eigen::Ref of 
+		 *                  any storage order) with a row per vector
+		 */
+		template<class RandomAccessIterator, class EmbeddingMatrix>
+		ProjectingFunction embedRange(RandomAccessIterator begin, RandomAccessIterator end,
+		                              const Eigen::MatrixBase<EmbeddingMatrix>& embedding) const
+		{
+			return (*this).withDistance(dummy_distance_callback<typename RandomAccessIterator::value_type>())
+						  .withFeatures(dummy_features_callback<typename RandomAccessIterator::value_type>())
+						  .embedRange(begin,end,embedding);
+		}
+
+		/** Constructs an embedding using the data represented by the container
+		 * and writes it to the provided matrix.
+		 *
+		 * @param container a container that supports begin() and end() methods 
+		 *                  to get corresponding iterators
+		 * @param embedding a writable matrix (e.g. Eigen::Map or Eigen::Ref of 
+		 *                  any storage order) with a row per vector
+		 */
+		template<class Container, class EmbeddingMatrix>
+		ProjectingFunction embedUsing(const Container& container, const Eigen::MatrixBase<EmbeddingMatrix>& embedding) const
+		{
+			return embedRange(container.begin(),container.end(),embedding);
+		}
 	private:
 		ParametersSet parameters;
 		KernelCallback kernel;
@@ -311,6 +462,37 @@ namespace tapkee_internal
 		{
 			return embedRange(container.begin(),container.end());
 		}
+
+		/** Constructs an embedding using the data represented by the 
+		 * begin and end iterators and writes it to the provided matrix.
+		 *
+		 * @param begin an iterator that points to the beginning of data container
+		 * @param end an iterator that points to the end of data container
+		 * @param embedding a writable matrix (e.g. Eigen::Map or Eigen::Ref of 
+		 *                  any storage order) with a row per vector
+		 */
+		template<class RandomAccessIterator, class EmbeddingMatrix>
+		ProjectingFunction embedRange(RandomAccessIterator begin, RandomAccessIterator end,
+		                              const Eigen::MatrixBase<EmbeddingMatrix>& embedding) const
+		{
+			return (*this).withKernel(dummy_kernel_callback<typename RandomAccessIterator::value_type>())
+						  .withFeatures(dummy_features_callback<typename RandomAccessIterator::value_type>())
+						  .embedRange(begin,end,embedding);
+		}
+
+		/** Constructs an embedding using the data represented by the container
+		 * and writes it to the provided matrix.
+		 *
+		 * @param container a container that supports begin() and end() methods 
+		 *                  to get corresponding iterators
+		 * @param embedding a writable matrix (e.g. Eigen::Map or Eigen::Ref of 
+		 *                  any storage order) with a row per vector
+		 */
+		template<class Container, class EmbeddingMatrix>
+		ProjectingFunction embedUsing(const Container& container, const Eigen::MatrixBase<EmbeddingMatrix>& embedding) const
+		{
+			return embedRange(container.begin(),container.end(),embedding);
+		}
 	private:
 		ParametersSet parameters;
 		DistanceCallback distance;
@@ -369,6 +551,37 @@ namespace tapkee_internal
 		{
 			return embedRange(container.begin(),container.end());
 		}
+
+		/** Constructs an embedding using the data represented by the 
+		 * begin and end iterators and writes it to the provided matrix.
+		 *
+		 * @param begin an iterator that points to the beginning of data container
+		 * @param end an iterator that points to the end of data container
+		 * @param embedding a writable matrix (e.g. Eigen::Map or Eigen::Ref of 
+		 *                  any storage order) with a row per vector
+		 */
+		template<class RandomAccessIterator, class EmbeddingMatrix>
+		ProjectingFunction embedRange(RandomAccessIterator begin, RandomAccessIterator end,
+		                              const Eigen::MatrixBase<EmbeddingMatrix>& embedding) const
+		{
+			return (*this).withKernel(dummy_kernel_callback<typename RandomAccessIterator::value_type>())
+						  .withDistance(dummy_distance_callback<typename RandomAccessIterator::value_type>())
+						  .embedRange(begin,end,embedding);
+		}
+
+		/** Constructs an embedding using the data represented by the container
+		 * and writes it to the provided matrix.
+		 *
+		 * @param container a container that supports begin() and end() methods 
+		 *                  to get corresponding iterators
+		 * @param embedding a writable matrix (e.g. Eigen::Map or Eigen::Ref of 
+		 *                  any storage order) with a row per vector
+		 */
+		template<class Container, class EmbeddingMatrix>
+		ProjectingFunction embedUsing(const Container& container, const Eigen::MatrixBase<EmbeddingMatrix>& embedding) const
+		{
+			return embedRange(container.begin(),container.end(),embedding);
+		}
 	private:
 		ParametersSet parameters;
 		FeaturesCallback features;
@@ -429,7 +642,106 @@ namespace tapkee_internal
 			eigen_features_callback fcb(matrix);
 			return tapkee::embed(indices.begin(),indices.end(),kcb,dcb,fcb,parameters);
 		}
+
+		/** Constructs an embedding using the data represented
+		 * by the feature matrix and writes it to the provided matrix. 
+		 * Uses linear kernel (dot product) and euclidean distance.
+		 * 
+		 * @param matrix matrix that contains feature vectors column-wise
+		 * @param embedding a writable matrix (e.g. Eigen::Map or Eigen::Ref of 
+		 *                  any storage order) with a row per feature vector
+		 */
+		template<class EmbeddingMatrix>
+		ProjectingFunction embedUsing(const DenseMatrix& matrix, const Eigen::MatrixBase<EmbeddingMatrix>& embedding) const
+		{
+			std::vector<IndexType> indices(matrix.cols());
+			for (IndexType i=0; i<matrix.cols(); i++) indices[i] = i;
+			eigen_kernel_callback kcb(matrix);
+			eigen_distance_callback dcb(matrix);
+			eigen_features_callback fcb(matrix);
+			return tapkee::embed(indices.begin(),indices.end(),kcb,dcb,fcb,parameters,embedding);
+		}
+
+		/** Constructs an embedding using the data represented
+		 * by the sparse feature matrix. Kernel and distance are 
+		 * computed over non-zero entries only, the data is never 
+		 * made dense except for single feature vectors requested 
+		 * by methods that need features. Uses linear kernel (dot 
+		 * product) and euclidean distance.
+		 * 
+		 * @param matrix sparse matrix that contains feature vectors column-wise
+		 */
+		TapkeeOutput embedUsing(const SparseMatrix& matrix) const
+		{
+			std::vector<IndexType> indices(matrix.cols());
+			for (IndexType i=0; i<matrix.cols(); i++) indices[i] = i;
+			eigen_sparse_kernel_callback kcb(matrix);
+			eigen_sparse_distance_callback dcb(matrix);
+			eigen_sparse_features_callback fcb(matrix);
+			return tapkee::embed(indices.begin(),indices.end(),kcb,dcb,fcb,parameters);
+		}
+
+		/** Constructs an embedding using the data represented
+		 * by any Eigen matrix that contains feature vectors column-wise,
+		 * e.g. an Eigen::Map over an external buffer or an Eigen::Ref 
+		 * with arbitrary strides. The data is used in place. Uses linear 
+		 * kernel (dot product) and euclidean distance.
+		 *
+		 * @param matrix matrix that contains feature vectors column-wise
+		 */
+		template<class MatrixType>
+		TapkeeOutput embedUsing(const Eigen::MatrixBase<MatrixType>& matrix) const
+		{
+			return embedMatrix<MatrixType,false>(matrix.derived());
+		}
+
+		/** Constructs an embedding using the data represented
+		 * by any Eigen matrix that contains feature vectors row-wise,
+		 * e.g. a row-major Eigen::Map over an external buffer. The data 
+		 * is used in place, no transposed copy is made. Uses linear 
+		 * kernel (dot product) and euclidean distance.
+		 *
+		 * @param matrix matrix that contains feature vectors row-wise
+		 */
+		template<class MatrixType>
+		TapkeeOutput embedUsingRowwise(const Eigen::MatrixBase<MatrixType>& matrix) const
+		{
+			return embedMatrix<MatrixType,true>(matrix.derived());
+		}
+
+		/** Constructs an embedding using the data represented
+		 * by any Eigen matrix that contains feature vectors row-wise
+		 * and writes it to the provided matrix.
+		 *
+		 * @param matrix matrix that contains feature vectors row-wise
+		 * @param embedding a writable matrix (e.g. Eigen::Map or Eigen::Ref of 
+		 *                  any storage order) with a row per feature vector
+		 */
+		template<class MatrixType, class EmbeddingMatrix>
+		ProjectingFunction embedUsingRowwise(const Eigen::MatrixBase<MatrixType>& matrix, 
+		                                     const Eigen::MatrixBase<EmbeddingMatrix>& embedding) const
+		{
+			const MatrixType& data = matrix.derived();
+			std::vector<IndexType> indices(data.rows());
+			for (IndexType i=0; i<data.rows(); i++) indices[i] = i;
+			eigen_matrix_kernel_callback<MatrixType,true> kcb(data);
+			eigen_matrix_distance_callback<MatrixType,true> dcb(data);
+			eigen_matrix_features_callback<MatrixType,true> fcb(data);
+			return tapkee::embed(indices.begin(),indices.end(),kcb,dcb,fcb,parameters,embedding);
+		}
 	private:
+		template<class MatrixType, bool in_rows>
+		TapkeeOutput embedMatrix(const MatrixType& matrix) const
+		{
+			const IndexType n_vectors = in_rows ? matrix.rows() : matrix.cols();
+			std::vector<IndexType> indices(n_vectors);
+			for (IndexType i=0; i<n_vectors; i++) indices[i] = i;
+			eigen_matrix_kernel_callback<MatrixType,in_rows> kcb(matrix);
+			eigen_matrix_distance_callback<MatrixType,in_rows> dcb(matrix);
+			eigen_matrix_features_callback<MatrixType,in_rows> fcb(matrix);
+			return tapkee::embed(indices.begin(),indices.end(),kcb,dcb,fcb,parameters);
+		}
+
 		ParametersSet parameters;
 	};
 } /* End of namespace tapkee_internal */
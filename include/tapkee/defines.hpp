@@ -45,16 +45,46 @@ namespace tapkee
 			embedding(), projection()
 		{
 		}
+		//! Copies the provided embedding
 		TapkeeOutput(const tapkee::DenseMatrix& e, const tapkee::ProjectingFunction& p) :
+			embedding(e), projection(p)
+		{
+		}
+		//! Takes over the storage of the provided embedding
+		//! (it is left empty) to avoid copying it
+		TapkeeOutput(tapkee::DenseMatrix& e, const tapkee::ProjectingFunction& p) :
 			embedding(), projection(p)
 		{
 			embedding.swap(e);
 		}
 		TapkeeOutput(const TapkeeOutput& that) :
-			embedding(), projection(that.projection)
+			embedding(that.embedding), projection(that.projection)
+		{
+		}
+		TapkeeOutput& operator=(const TapkeeOutput& that)
 		{
-			this->embedding.swap(that.embedding);
+			embedding = that.embedding;
+			projection = that.projection;
+			return *this;
 		}
+#ifdef TAPKEE_HAS_RVALUE_REFERENCES
+		TapkeeOutput(tapkee::DenseMatrix&& e, const tapkee::ProjectingFunction& p) :
+			embedding(), projection(p)
+		{
+			embedding.swap(e);
+		}
+		TapkeeOutput(TapkeeOutput&& that) :
+			embedding(), projection(std::move(that.projection))
+		{
+			embedding.swap(that.embedding);
+		}
+		TapkeeOutput& operator=(TapkeeOutput&& that)
+		{
+			embedding.swap(that.embedding);
+			projection = std::move(that.projection);
+			return *this;
+		}
+#endif
 		tapkee::DenseMatrix embedding;
 		tapkee::ProjectingFunction projection;
 	};
@@ -8,6 +8,7 @@
 
 /* Tapkee includes */
 #include <tapkee/defines/types.hpp>
+#include <tapkee/defines/synonyms.hpp>
 
 #include <stichwort/keywords.hpp>
 /* End of Tapkee includes */
@@ -46,6 +47,7 @@ namespace tapkee
 		 * - @ref tapkee::LinearLocalTangentSpaceAlignment
 		 * - @ref tapkee::HessianLocallyLinearEmbedding
 		 * - @ref tapkee::LaplacianEigenmaps
+		 * - @ref tapkee::LandmarkLaplacianEigenmaps
 		 * - @ref tapkee::LocalityPreservingProjections
 		 * - @ref tapkee::DiffusionMap
 		 * - @ref tapkee::Isomap
@@ -99,6 +101,7 @@ namespace tapkee
 		 * - @ref tapkee::LinearLocalTangentSpaceAlignment
 		 * - @ref tapkee::HessianLocallyLinearEmbedding
 		 * - @ref tapkee::LaplacianEigenmaps
+		 * - @ref tapkee::LandmarkLaplacianEigenmaps
 		 * - @ref tapkee::LocalityPreservingProjections
 		 * - @ref tapkee::Isomap
 		 * - @ref tapkee::LandmarkIsomap
@@ -140,12 +143,30 @@ namespace tapkee
 		const stichwort::ParameterKeyword<IndexType>
 			diffusion_map_timesteps("diffusion map timesteps", 3);
 
+		/** The keyword for the value that indicates whether 
+		 * the diffusion map should be computed with the Nystrom 
+		 * approximation, i.e. with only kernel values between 
+		 * vectors and randomly selected landmarks (see 
+		 * @ref tapkee::keywords::landmark_ratio). Reduces memory
+		 * requirements from \f$ O(N^2) \f$ to \f$ O(Nm) \f$ where 
+		 * \f$ m \f$ is the number of landmarks.
+		 *
+		 * Used by @ref tapkee::DiffusionMap.
+		 *
+		 * Default is false.
+		 *
+		 * The corresponding value should have type bool.
+		 */
+		const stichwort::ParameterKeyword<bool>
+			diffusion_map_nystrom("diffusion map Nystrom approximation", false);
+
 		/** The keyword for the value that stores the width of
 		 * the gaussian kernel.
 		 *
 		 * Used by the following methods:
 		 *
 		 * - @ref tapkee::LaplacianEigenmaps
+		 * - @ref tapkee::LandmarkLaplacianEigenmaps
 		 * - @ref tapkee::LocalityPreservingProjections
 		 * - @ref tapkee::DiffusionMap
 		 *
@@ -216,6 +237,9 @@ namespace tapkee
 		 *
 		 * - @ref tapkee::LandmarkIsomap
 		 * - @ref tapkee::LandmarkMultidimensionalScaling
+		 * - @ref tapkee::LandmarkLaplacianEigenmaps
+		 * - @ref tapkee::DiffusionMap (when @ref tapkee::keywords::diffusion_map_nystrom
+		 *        is set to true)
 		 *
 		 * Default is 0.5.
 		 *  
@@ -363,6 +387,67 @@ namespace tapkee
 		 * The corresponding value should have type @ref tapkee::ScalarType.
 		 */
 		const stichwort::ParameterKeyword<ScalarType> squishing_rate("squishing rate", 0.99);
+
+		/** The keyword for the value that indicates whether exactly
+		 * equal feature vectors should be collapsed before embedding.
+		 * 
+		 * If set, feature vectors are hashed, the method is run on
+		 * distinct vectors only and duplicates get the embedding of 
+		 * their representatives. Requires the features callback, 
+		 * ignored if it is not provided.
+		 *
+		 * Default is false.
+		 *
+		 * The corresponding value should have type bool.
+		 */
+		const stichwort::ParameterKeyword<bool>
+			collapse_duplicates("collapse duplicates", false);
+
+		/** The keyword for the value that stores the number of 
+		 * vectors the method is run on. If it is positive and less 
+		 * than the number of vectors, the selected method embeds 
+		 * only a sample of vectors (see @ref tapkee::keywords::sampling_method)
+		 * and the rest of vectors is embedded with the projecting 
+		 * function of the method (if it is implemented and the features 
+		 * callback is provided) or interpolated from embedding of 
+		 * nearest samples otherwise (with the number of nearest 
+		 * samples set by @ref tapkee::keywords::num_neighbors).
+		 *
+		 * Default is 0, i.e. all vectors are embedded by the method.
+		 *
+		 * The corresponding value should have type @ref tapkee::IndexType.
+		 */
+		const stichwort::ParameterKeyword<IndexType>
+			sample_size("sample size", 0);
+
+		/** The keyword for the value that stores the method
+		 * used to select the sample (see @ref tapkee::keywords::sample_size).
+		 *
+		 * Default is @ref tapkee::UniformSampling.
+		 *
+		 * The corresponding value should have type @ref tapkee::SamplingMethod.
+		 */
+		const stichwort::ParameterKeyword<SamplingMethod>
+			sampling_method("sampling method", UniformSampling);
+
+		/** The keyword for the value that stores a pointer to 
+		 * precomputed neighbors of vectors. The i-th list should contain 
+		 * indices of nearest neighbors of the i-th vector sorted by increasing 
+		 * distance and have at least @ref tapkee::keywords::num_neighbors 
+		 * elements, only that many first neighbors are used. It allows to 
+		 * reuse the neighborhood graph between runs with different parameters 
+		 * on the same data (see @ref tapkee::tapkee_internal::sort_neighbors). 
+		 * Can't be used together with @ref tapkee::keywords::collapse_duplicates 
+		 * or @ref tapkee::keywords::sample_size since they change the set of 
+		 * vectors to embed.
+		 *
+		 * Default is NULL, i.e. neighbors are computed.
+		 *
+		 * The corresponding value should have type 
+		 * @code const tapkee::tapkee_internal::Neighbors* @endcode
+		 */
+		const stichwort::ParameterKeyword<const tapkee_internal::Neighbors*>
+			precomputed_neighbors("precomputed neighbors", NULL);
 	}
 }
 
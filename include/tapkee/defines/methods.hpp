@@ -29,6 +29,9 @@ namespace tapkee
 		/** Laplacian Eigenmaps as described in 
 		 * @cite Belkin2002 */
 		LaplacianEigenmaps,
+		/** Landmark (anchor graph) Laplacian Eigenmaps as described in
+		 * @cite Liu2010 */
+		LandmarkLaplacianEigenmaps,
 		/** Locality Preserving Projections as described in 
 		 * @cite He2003 */
 		LocalityPreservingProjections,
@@ -79,6 +82,7 @@ namespace tapkee
 	METHOD_THAT_NEEDS_KERNEL_AND_FEATURES_IS(LinearLocalTangentSpaceAlignment);
 	METHOD_THAT_NEEDS_ONLY_KERNEL_IS(HessianLocallyLinearEmbedding);
 	METHOD_THAT_NEEDS_ONLY_DISTANCE_IS(LaplacianEigenmaps);
+	METHOD_THAT_NEEDS_ONLY_DISTANCE_IS(LandmarkLaplacianEigenmaps);
 	METHOD_THAT_NEEDS_DISTANCE_AND_FEATURES_IS(LocalityPreservingProjections);
 	METHOD_THAT_NEEDS_ONLY_DISTANCE_IS(DiffusionMap);
 	METHOD_THAT_NEEDS_ONLY_DISTANCE_IS(Isomap);
@@ -137,6 +141,14 @@ namespace tapkee
 	static const NeighborsMethod Brute("Brute-force");
 	//! Vantage point tree -based method.
 	static const NeighborsMethod VpTree("Vantage point tree");
+	//! KD-tree -based method. Uses Euclidean distance between feature
+	//! vectors thus requires features callback. Recommended for
+	//! low-dimensional (up to ~16 dimensions) data.
+	static const NeighborsMethod KdTree("KD-tree");
+	//! Ball tree -based method. Uses Euclidean distance between feature
+	//! vectors thus requires features callback. Recommended for data
+	//! of moderate dimensionality.
+	static const NeighborsMethod BallTree("Ball tree");
 #ifdef TAPKEE_USE_LGPL_COVERTREE
 	//! Covertree-based method with approximate \f$ O(\log N) \f$ time complexity.
 	//! Recommended to be used as a default method.
@@ -168,6 +180,18 @@ namespace tapkee
 	//! Eigen library dense method (could be useful for debugging). Computes
 	//! all eigenvectors thus can be very slow doing large-scale.
 	static const EigenMethod Dense("Dense");
+	//! Locally optimal block preconditioned conjugate gradient method.
+	//! Applies the operation to blocks of vectors so it relies on 
+	//! matrix-matrix products. Smallest eigenproblems of sparse matrices
+	//! are preconditioned with smoothed aggregation algebraic multigrid.
+	//! Supports standard eigenproblems and generalized eigenproblems 
+	//! of Laplacian eigenmaps.
+	static const EigenMethod Lobpcg("LOBPCG");
+	//! Chebyshev filtered subspace iteration. Requires only products of
+	//! the matrix with blocks of vectors and no factorizations, recommended 
+	//! for Laplacian spectra of large graphs. Supports standard eigenproblems 
+	//! and generalized eigenproblems of Laplacian eigenmaps.
+	static const EigenMethod ChebyshevFilter("Chebyshev filtered subspace iteration");
 
 #ifdef TAPKEE_WITH_ARPACK
 	static EigenMethod default_eigen_method = Arpack;
@@ -189,6 +213,20 @@ namespace tapkee
 
 	static ComputationStrategy default_computation_strategy = HomogeneousCPUStrategy; 
 
+	struct SamplingMethod : public Method<SamplingMethod>
+	{
+		SamplingMethod(const char* n) : Method<SamplingMethod>(n)
+		{
+		}
+	};
+
+	//! Vectors of the sample are selected uniformly at random.
+	static const SamplingMethod UniformSampling("Uniform sampling");
+	//! Each next vector of the sample is the farthest one from
+	//! already selected vectors. Covers the data more evenly
+	//! than uniform sampling at the cost of \f$ O(Nm) \f$ distances.
+	static const SamplingMethod FarthestPointSampling("Farthest point sampling");
+
 	namespace tapkee_internal
 	{
 
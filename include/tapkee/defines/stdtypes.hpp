@@ -19,4 +19,15 @@
 	#define TAPKEE_INTERNAL_MAP std::map
 #endif
 
+#if __cplusplus >= 201103L || (defined(_MSC_VER) && _MSC_VER >= 1700)
+	#include <utility>
+	#define TAPKEE_HAS_RVALUE_REFERENCES
+	#ifndef TAPKEE_HAS_ATOMICS
+		#define TAPKEE_HAS_ATOMICS 1
+	#endif
+#endif
+#ifndef TAPKEE_HAS_ATOMICS
+	#define TAPKEE_HAS_ATOMICS 0
+#endif
+
 #endif
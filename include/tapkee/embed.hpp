@@ -11,8 +11,73 @@
 #include <tapkee/methods.hpp>
 /* End of Tapkee includes */
 
+#include <vector>
+#include <iterator>
+
 namespace tapkee
 {
+namespace tapkee_internal
+{
+
+//! Embeds provided data with the selected method. If the sample size
+//! is set and is less than the number of vectors, the method embeds
+//! only a sample of vectors and the rest of vectors is either projected
+//! with the projecting function of the method (if available) or
+//! interpolated from the embedding of nearest samples.
+template <class RandomAccessIterator, class KernelCallback, class DistanceCallback, class FeaturesCallback>
+TapkeeOutput embed_sampled(RandomAccessIterator begin, RandomAccessIterator end,
+                           KernelCallback kernel_callback, DistanceCallback distance_callback,
+                           FeaturesCallback features_callback, stichwort::ParametersSet& parameters,
+                           const Context& context, DimensionReductionMethod selected_method)
+{
+	const IndexType n_vectors = end-begin;
+	IndexType n_samples = parameters[sample_size];
+	if (n_samples <= 0 || n_samples >= n_vectors)
+	{
+		return initialize(begin,end,kernel_callback,distance_callback,features_callback,parameters,context)
+		                 .embedUsing(selected_method);
+	}
+
+	SamplingMethod selected_sampling_method = parameters[sampling_method];
+	SamplingDistance<KernelCallback,DistanceCallback,FeaturesCallback>
+		sampling_distance(kernel_callback,distance_callback,features_callback);
+	Landmarks samples = selected_sampling_method.is(FarthestPointSampling) ?
+		select_samples_farthest(begin,end,sampling_distance,n_samples) :
+		select_samples_uniform(n_vectors,n_samples);
+
+	LoggingSingleton::instance().message_info(formatting::format("Embedding a sample of {} vectors out of {} ({}).",
+		n_samples, n_vectors, get_sampling_method_name(selected_sampling_method)));
+
+	typedef typename std::iterator_traits<RandomAccessIterator>::value_type DataType;
+	std::vector<DataType> sampled;
+	sampled.reserve(n_samples);
+	for (IndexType i=0; i<n_samples; ++i)
+		sampled.push_back(*(begin+samples[i]));
+
+	TapkeeOutput output = initialize(sampled.begin(),sampled.end(),
+	                                 kernel_callback,distance_callback,features_callback,parameters,context)
+	                                 .embedUsing(selected_method);
+
+	DenseMatrix embedding(n_vectors,output.embedding.cols());
+	for (IndexType i=0; i<n_samples; ++i)
+		embedding.row(samples[i]) = output.embedding.row(i);
+
+	if (output.projection.implementation && !is_dummy<FeaturesCallback>::value)
+	{
+		project_embedding(begin,end,samples,features_callback,output.projection,embedding);
+	}
+	else
+	{
+		IndexType n_neighbors = parameters[num_neighbors];
+		interpolate_embedding(begin,end,samples,output.embedding,sampling_distance,n_neighbors,embedding);
+	}
+
+	output.embedding.swap(embedding);
+	return output;
+}
+
+}
+
 /** Constructs a dense embedding with specified 
  * dimensionality using provided data represented by random access iterators 
  * and provided callbacks. Returns ReturnType that is essentially a pair of 
@@ -58,6 +123,7 @@ namespace tapkee
  * @code ScalarType distance(const RandomAccessIterator::value_type&, const RandomAccessIterator::value_type&) @endcode 
  * Used by the following methods: 
  * - @ref tapkee::LaplacianEigenmaps
+ * - @ref tapkee::LandmarkLaplacianEigenmaps
  * - @ref tapkee::LocalityPreservingProjections
  * - @ref tapkee::DiffusionMap
  * - @ref tapkee::Isomap
@@ -115,8 +181,36 @@ TapkeeOutput embed(RandomAccessIterator begin, RandomAccessIterator end,
 
 		LoggingSingleton::instance().message_info(formatting::format("Using the {} method.", get_method_name(selected_method)));
 		
-		output = tapkee_internal::initialize(begin,end,kernel_callback,distance_callback,features_callback,parameters,context)
-								 .embedUsing(selected_method);
+		bool collapse = parameters[collapse_duplicates];
+		if (collapse && is_dummy<FeaturesCallback>::value)
+		{
+			LoggingSingleton::instance().message_warning("Duplicates can't be collapsed without the features callback.");
+			collapse = false;
+		}
+
+		if (collapse)
+		{
+			tapkee_internal::UniqueVectors unique = 
+				tapkee_internal::find_unique_vectors(begin,end,features_callback,features_callback.dimension());
+			LoggingSingleton::instance().message_info(formatting::format("Collapsed {} duplicates, {} distinct vectors remain.",
+				(end-begin)-unique.representatives.size(), unique.representatives.size()));
+
+			typedef typename std::iterator_traits<RandomAccessIterator>::value_type DataType;
+			std::vector<DataType> representatives;
+			representatives.reserve(unique.representatives.size());
+			for (size_t i=0; i<unique.representatives.size(); ++i)
+				representatives.push_back(*(begin+unique.representatives[i]));
+
+			output = tapkee_internal::embed_sampled(representatives.begin(),representatives.end(),
+			                                        kernel_callback,distance_callback,features_callback,
+			                                        parameters,context,selected_method);
+			output.embedding = tapkee_internal::expand_embedding(output.embedding,unique);
+		}
+		else
+		{
+			output = tapkee_internal::embed_sampled(begin,end,kernel_callback,distance_callback,features_callback,
+			                                        parameters,context,selected_method);
+		}
 	}
 	catch (const std::bad_alloc&)
 	{
@@ -141,5 +235,56 @@ TapkeeOutput embed(RandomAccessIterator begin, RandomAccessIterator end,
 
 	return output;
 }
+
+/** Constructs a dense embedding with specified dimensionality just like
+ * @ref tapkee::embed does but writes the embedding to the provided matrix
+ * so that the caller doesn't have to copy (and possibly transpose) it out of
+ * the returned one. The matrix can be any writable Eigen expression of proper 
+ * size, e.g. an Eigen::Map over a caller-owned buffer or an Eigen::Ref, with 
+ * either row-major or column-major storage order and arbitrary strides. 
+ * The storage of the method's result is released before returning.
+ *
+ * @param begin begin iterator of data
+ * @param end end iterator of data
+ * @param kernel_callback the kernel callback (see @ref tapkee::embed)
+ * @param distance_callback the distance callback (see @ref tapkee::embed)
+ * @param feature_vector_callback the feature vector callback (see @ref tapkee::embed)
+ * @param parameters a set of parameters formed with keywords expression.
+ * @param embedding matrix of (end-begin) rows and target dimension columns
+ *        the embedding is written to, i-th row is the embedding of i-th vector
+ *
+ * @return projecting function (if implemented by the method)
+ *
+ * @throw tapkee::wrong_parameter_error if the size of the provided matrix doesn't 
+ *        match the embedding or wrong parameter value is passed
+ * @throw any of exceptions thrown by @ref tapkee::embed
+ */
+template <class RandomAccessIterator, class KernelCallback, class DistanceCallback, 
+          class FeaturesCallback, class EmbeddingMatrix>
+ProjectingFunction embed(RandomAccessIterator begin, RandomAccessIterator end,
+                         KernelCallback kernel_callback, DistanceCallback distance_callback,
+                         FeaturesCallback features_callback, stichwort::ParametersSet parameters,
+                         const Eigen::MatrixBase<EmbeddingMatrix>& embedding)
+{
+	// the usual way to pass writable Eigen expressions (temporary maps, blocks) 
+	Eigen::MatrixBase<EmbeddingMatrix>& destination = const_cast<Eigen::MatrixBase<EmbeddingMatrix>&>(embedding);
+
+	if (destination.rows() != (end-begin))
+	{
+		throw wrong_parameter_error(formatting::format("The output matrix has {} rows while there are {} vectors.",
+			destination.rows(), (end-begin)));
+	}
+
+	TapkeeOutput output = embed(begin,end,kernel_callback,distance_callback,features_callback,parameters);
+
+	if (destination.cols() != output.embedding.cols())
+	{
+		throw wrong_parameter_error(formatting::format("The output matrix has {} columns while the embedding has {}.",
+			destination.cols(), output.embedding.cols()));
+	}
+
+	destination = output.embedding;
+	return output.projection;
+}
 }
 #endif
@@ -45,6 +45,9 @@
 #include <stdio.h>
 #include <cstring>
 #include <time.h>
+#include <vector>
+#include <algorithm>
+#include <utility>
 
 //! Namespace containing implementation of t-SNE algorithm
 namespace tsne
@@ -195,90 +198,90 @@ public:
 		}
 	}
 
+	// Symmetrizes the sparse matrix in CSR format with P = (P + P^T)/2.
+	// The transpose is built with a counting sort on columns (which
+	// keeps its rows sorted), rows of the matrix are sorted by column
+	// in parallel and then each row is merged with the corresponding
+	// row of the transpose in parallel. Rows of the result are sorted.
 	void symmetrizeMatrix(int** _row_P, int** _col_P, ScalarType** _val_P, int N)
-	{ 
+	{
+		typedef std::pair<int,ScalarType> Entry;
+
 		// Get sparse matrix
 		int* row_P = *_row_P;
 		int* col_P = *_col_P;
 		ScalarType* val_P = *_val_P;
+		const int nnz = row_P[N];
 
-		// Count number of elements and row counts of symmetric matrix
-		int* row_counts = (int*) calloc(N, sizeof(int));
-		if(row_counts == NULL) { printf("Memory allocation failed!\n"); exit(1); }
+		// Sort rows of the matrix by column
+		std::vector<Entry> entries(nnz);
+#pragma omp parallel for schedule(dynamic,256)
 		for(int n = 0; n < N; n++) {
-			for(int i = row_P[n]; i < row_P[n + 1]; i++) {
-				// Check whether element (col_P[i], n) is present
-				bool present = false;
-				for(int m = row_P[col_P[i]]; m < row_P[col_P[i] + 1]; m++) {
-					if(col_P[m] == n) present = true;
-				}
-				if(present) row_counts[n]++;
-				else {
-					row_counts[n]++;
-					row_counts[col_P[i]]++;
-				}
+			for(int i = row_P[n]; i < row_P[n + 1]; i++) entries[i] = Entry(col_P[i], val_P[i]);
+			std::sort(entries.begin() + row_P[n], entries.begin() + row_P[n + 1]);
+		}
+
+		// Build the transpose with the counting sort on columns
+		std::vector<int> row_T(N + 1, 0);
+		for(int i = 0; i < nnz; i++) row_T[col_P[i] + 1]++;
+		for(int n = 0; n < N; n++) row_T[n + 1] += row_T[n];
+		std::vector<Entry> entries_T(nnz);
+		{
+			std::vector<int> offset(row_T.begin(), row_T.end() - 1);
+			for(int n = 0; n < N; n++) {
+				for(int i = row_P[n]; i < row_P[n + 1]; i++) entries_T[offset[col_P[i]]++] = Entry(n, val_P[i]);
 			}
 		}
-		int no_elem = 0;
-		for(int n = 0; n < N; n++) no_elem += row_counts[n];
-		
-		// Allocate memory for symmetrized matrix
-		int*    sym_row_P = (int*)    malloc((N + 1) * sizeof(int));
+
+		// Count number of elements in each row of symmetric matrix
+		int* sym_row_P = (int*) malloc((N + 1) * sizeof(int));
+		if(sym_row_P == NULL) { printf("Memory allocation failed!\n"); exit(1); }
+		sym_row_P[0] = 0;
+#pragma omp parallel for schedule(dynamic,256)
+		for(int n = 0; n < N; n++) {
+			int i = row_P[n], j = row_T[n], count = 0;
+			while(i < row_P[n + 1] || j < row_T[n + 1]) {
+				if(j == row_T[n + 1] || (i < row_P[n + 1] && entries[i].first < entries_T[j].first)) i++;
+				else if(i == row_P[n + 1] || entries_T[j].first < entries[i].first) j++;
+				else { i++; j++; }
+				count++;
+			}
+			sym_row_P[n + 1] = count;
+		}
+		for(int n = 0; n < N; n++) sym_row_P[n + 1] += sym_row_P[n];
+		const int no_elem = sym_row_P[N];
+
+		// Merge rows of the matrix and its transpose
 		int*    sym_col_P = (int*)    malloc(no_elem * sizeof(int));
 		ScalarType* sym_val_P = (ScalarType*) malloc(no_elem * sizeof(ScalarType));
-		if(sym_row_P == NULL || sym_col_P == NULL || sym_val_P == NULL) { printf("Memory allocation failed!\n"); exit(1); }
-		
-		// Construct new row indices for symmetric matrix
-		sym_row_P[0] = 0;
-		for(int n = 0; n < N; n++) sym_row_P[n + 1] = sym_row_P[n] + row_counts[n];
-		
-		// Fill the result matrix
-		int* offset = (int*) calloc(N, sizeof(int));
-		if(offset == NULL) { printf("Memory allocation failed!\n"); exit(1); }
+		if(sym_col_P == NULL || sym_val_P == NULL) { printf("Memory allocation failed!\n"); exit(1); }
+#pragma omp parallel for schedule(dynamic,256)
 		for(int n = 0; n < N; n++) {
-			for(int i = row_P[n]; i < row_P[n + 1]; i++) {                                  // considering element(n, col_P[i])
-				
-				// Check whether element (col_P[i], n) is present
-				bool present = false;
-				for(int m = row_P[col_P[i]]; m < row_P[col_P[i] + 1]; m++) {
-					if(col_P[m] == n) {
-						present = true;
-						if(n <= col_P[i]) {                                                 // make sure we do not add elements twice
-							sym_col_P[sym_row_P[n]        + offset[n]]        = col_P[i];
-							sym_col_P[sym_row_P[col_P[i]] + offset[col_P[i]]] = n;
-							sym_val_P[sym_row_P[n]        + offset[n]]        = val_P[i] + val_P[m];
-							sym_val_P[sym_row_P[col_P[i]] + offset[col_P[i]]] = val_P[i] + val_P[m];
-						}
-					}
+			int i = row_P[n], j = row_T[n], k = sym_row_P[n];
+			while(i < row_P[n + 1] || j < row_T[n + 1]) {
+				if(j == row_T[n + 1] || (i < row_P[n + 1] && entries[i].first < entries_T[j].first)) {
+					sym_col_P[k] = entries[i].first;
+					sym_val_P[k] = entries[i].second / 2.0;
+					i++;
 				}
-				
-				// If (col_P[i], n) is not present, there is no addition involved
-				if(!present) {
-					sym_col_P[sym_row_P[n]        + offset[n]]        = col_P[i];
-					sym_col_P[sym_row_P[col_P[i]] + offset[col_P[i]]] = n;
-					sym_val_P[sym_row_P[n]        + offset[n]]        = val_P[i];
-					sym_val_P[sym_row_P[col_P[i]] + offset[col_P[i]]] = val_P[i];
+				else if(i == row_P[n + 1] || entries_T[j].first < entries[i].first) {
+					sym_col_P[k] = entries_T[j].first;
+					sym_val_P[k] = entries_T[j].second / 2.0;
+					j++;
 				}
-				
-				// Update offsets
-				if(!present || (present && n <= col_P[i])) {
-					offset[n]++;
-					if(col_P[i] != n) offset[col_P[i]]++;               
+				else {
+					sym_col_P[k] = entries[i].first;
+					sym_val_P[k] = (entries[i].second + entries_T[j].second) / 2.0;
+					i++; j++;
 				}
+				k++;
 			}
 		}
-		
-		// Divide the result by two
-		for(int i = 0; i < no_elem; i++) sym_val_P[i] /= 2.0;
-		
+
 		// Return symmetrized matrices
 		free(*_row_P); *_row_P = sym_row_P;
 		free(*_col_P); *_col_P = sym_col_P;
 		free(*_val_P); *_val_P = sym_val_P;
-		
-		// Free up some memery
-		free(offset); offset = NULL;
-		free(row_counts); row_counts  = NULL;
 	}
     
 private:
@@ -27,6 +27,9 @@
 #include <tapkee/routines/spe.hpp>
 #include <tapkee/routines/fa.hpp>
 #include <tapkee/routines/manifold_sculpting.hpp>
+#include <tapkee/routines/duplicates.hpp>
+#include <tapkee/routines/sampling.hpp>
+#include <tapkee/routines/tsne_projection.hpp>
 #include <tapkee/neighbors/neighbors.hpp>
 #include <tapkee/external/barnes_hut_sne/tsne.hpp>
 /* End of Tapkee includes */
@@ -109,10 +112,10 @@ public:
 		kernel_distance(KernelDistance<RandomAccessIterator,KernelCallback>(kernel)),
 		begin(b), end(e), p_computation_strategy(),
 		p_eigen_method(), p_neighbors_method(), p_eigenshift(), p_traceshift(),
-		p_check_connectivity(), p_n_neighbors(), p_width(), p_timesteps(),
+		p_check_connectivity(), p_n_neighbors(), p_width(), p_timesteps(), p_nystrom(),
 		p_ratio(), p_max_iteration(), p_tolerance(), p_n_updates(), p_perplexity(), 
 		p_theta(), p_squishing_rate(), p_global_strategy(), p_epsilon(), p_target_dimension(),
-		n_vectors(0), current_dimension(0)
+		p_precomputed_neighbors(), n_vectors(0), current_dimension(0)
 	{
 		n_vectors = (end-begin);
 
@@ -131,6 +134,7 @@ public:
 		p_check_connectivity = parameters[check_connectivity];
 		p_width = parameters[gaussian_kernel_width].checked().satisfies(Positivity<ScalarType>());
 		p_timesteps = parameters[diffusion_map_timesteps].checked().satisfies(Positivity<IndexType>());
+		p_nystrom = parameters[diffusion_map_nystrom];
 		p_eigenshift = parameters[nullspace_shift];
 		p_traceshift = parameters[klle_shift];
 		p_max_iteration = parameters[max_iteration];
@@ -142,6 +146,7 @@ public:
 		p_epsilon = parameters[fa_epsilon].checked().satisfies(NonNegativity<ScalarType>());
 		p_perplexity = parameters[sne_perplexity].checked().satisfies(NonNegativity<ScalarType>());
 		p_ratio = parameters[landmark_ratio];
+		p_precomputed_neighbors = parameters[precomputed_neighbors];
 
 		if (!is_dummy<FeaturesCallback>::value)
 			current_dimension = features.dimension();
@@ -185,6 +190,7 @@ public:
 			tapkee_method_handle(LinearLocalTangentSpaceAlignment);
 			tapkee_method_handle(HessianLocallyLinearEmbedding);
 			tapkee_method_handle(LaplacianEigenmaps);
+			tapkee_method_handle(LandmarkLaplacianEigenmaps);
 			tapkee_method_handle(LocalityPreservingProjections);
 			tapkee_method_handle(PCA);
 			tapkee_method_handle(KernelPCA);
@@ -221,6 +227,7 @@ private:
 	Parameter p_n_neighbors;
 	Parameter p_width;
 	Parameter p_timesteps;
+	Parameter p_nystrom;
 	Parameter p_ratio;
 	Parameter p_max_iteration;
 	Parameter p_tolerance;
@@ -231,6 +238,7 @@ private:
 	Parameter p_global_strategy;
 	Parameter p_epsilon;
 	Parameter p_target_dimension;
+	Parameter p_precomputed_neighbors;
 
 	IndexType n_vectors;
 	IndexType current_dimension;
@@ -238,6 +246,12 @@ private:
 	template<class Distance>
 	Neighbors findNeighborsWith(Distance d)
 	{
+		const Neighbors* precomputed = p_precomputed_neighbors;
+		if (precomputed)
+			return truncated_neighbors(*precomputed,p_n_neighbors,n_vectors);
+		if (!is_dummy<FeaturesCallback>::value)
+			return find_neighbors(p_neighbors_method,begin,end,d,features,current_dimension,
+			                      p_n_neighbors,p_check_connectivity);
 		return find_neighbors(p_neighbors_method,begin,end,d,p_n_neighbors,p_check_connectivity);
 	}
 
@@ -278,6 +292,18 @@ private:
 
 	TapkeeOutput embedDiffusionMap()
 	{
+		if (p_nystrom.is(true))
+		{
+			p_ratio.checked().satisfies(InClosedRange<ScalarType>(3.0/n_vectors,1.0));
+
+			Landmarks landmarks = 
+				select_landmarks_random(begin,end,p_ratio);
+			DenseMatrix diffusion_matrix =
+				compute_diffusion_matrix_nystrom(begin,end,landmarks,distance,p_timesteps,p_width);
+			return TapkeeOutput(nystrom_diffusion_embedding(diffusion_matrix,landmarks,p_eigen_method,
+					p_computation_strategy,p_target_dimension), unimplementedProjectingFunction());
+		}
+
 		DenseSymmetricMatrix diffusion_matrix =
 			compute_diffusion_matrix(begin,end,distance,p_timesteps,p_width);
 		DenseMatrix embedding =
@@ -418,6 +444,34 @@ private:
 				unimplementedProjectingFunction());
 	}
 
+	TapkeeOutput embedLandmarkLaplacianEigenmaps()
+	{
+		p_ratio.checked().satisfies(InClosedRange<ScalarType>(3.0/n_vectors,1.0));
+
+		Landmarks anchors = 
+			select_landmarks_random(begin,end,p_ratio);
+		IndexType n_nearest = std::min(static_cast<IndexType>(p_n_neighbors),static_cast<IndexType>(anchors.size()));
+		SparseWeightMatrix anchor_graph = 
+			compute_anchor_graph(begin,end,anchors,distance,n_nearest,p_width);
+		DenseMatrix anchors_embedding = 
+			compute_anchors_embedding(anchor_graph,p_eigen_method,p_computation_strategy,p_target_dimension);
+		DenseMatrix embedding = anchor_graph*anchors_embedding;
+
+		if (is_dummy<FeaturesCallback>::value)
+			return TapkeeOutput(embedding,unimplementedProjectingFunction());
+
+		DenseMatrix anchor_vectors(current_dimension,anchors.size());
+		DenseVector anchor_vector(current_dimension);
+		for (IndexType j=0; j<static_cast<IndexType>(anchors.size()); ++j)
+		{
+			features.vector(begin[anchors[j]],anchor_vector);
+			anchor_vectors.col(j) = anchor_vector;
+		}
+		tapkee::ProjectingFunction projecting_function(
+			new AnchorGraphProjectionImplementation(anchor_vectors,anchors_embedding,n_nearest,p_width));
+		return TapkeeOutput(embedding,projecting_function);
+	}
+
 	TapkeeOutput embedLocalityPreservingProjections()
 	{
 		Neighbors neighbors = findNeighborsWith(plain_distance);
@@ -521,11 +575,17 @@ private:
 		DenseMatrix data = 
 			dense_matrix_from_features(features, current_dimension, begin, end);
 
+		// t-SNE centers and scales data in place, the same is done for new vectors
+		DenseVector mean_vector = data.rowwise().mean();
+		ScalarType scale = (data.colwise() - mean_vector).maxCoeff();
+
 		DenseMatrix embedding(static_cast<IndexType>(p_target_dimension),n_vectors);
 		tsne::TSNE tsne;
 		tsne.run(data.data(),n_vectors,current_dimension,embedding.data(),p_target_dimension,p_perplexity,p_theta);
 
-		return TapkeeOutput(embedding.transpose(), unimplementedProjectingFunction());
+		tapkee::ProjectingFunction projecting_function(
+			new TSNEProjectionImplementation(data,mean_vector,scale,embedding,p_perplexity));
+		return TapkeeOutput(embedding.transpose(), projecting_function);
 	}
 
 	TapkeeOutput embedManifoldSculpting()
@@ -0,0 +1,214 @@
+/* This software is distributed under BSD 3-clause license (see LICENSE file).
+ *
+ * Copyright (c) 2012-2013 Sergey Lisitsyn
+ */
+
+#ifndef TAPKEE_BALLTREE_H_
+#define TAPKEE_BALLTREE_H_
+
+/* Tapkee includes */
+#include <tapkee/defines.hpp>
+#include <tapkee/neighbors/kdtree.hpp>
+/* End of Tapkee includes */
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+namespace tapkee
+{
+namespace tapkee_internal
+{
+
+//! Ball tree over feature vectors with Euclidean distance.
+//!
+//! Nodes are balls around centroids of their points. Points are split
+//! by the median of their projections onto the direction between two
+//! distant points of the node. Just like in @ref KDimensionalTree points are stored
+//! contiguously in the tree order and distances to points of leaves are
+//! abandoned once they exceed the current k-th nearest one. Prunes better than the KD-tree for moderate
+//! dimensionality.
+//!
+class MetricBallTree
+{
+public:
+	//! Constructs the tree
+	//!
+	//! @param points matrix with feature vectors in columns
+	//! @param leaf_size maximal number of points in a leaf
+	//!
+	MetricBallTree(const DenseMatrix& points, IndexType leaf_size=16) :
+		data(), indices(points.cols()), nodes(), centers(), bucket(leaf_size)
+	{
+		for (IndexType i=0; i<points.cols(); ++i)
+			indices[i] = i;
+		nodes.reserve(2*(points.cols()/bucket+1));
+		centers.resize(points.rows(),2*(points.cols()/bucket+1));
+		// projections of points used to split nodes
+		DenseVector projections(points.cols());
+		if (points.cols() > 0)
+			build(points,projections,0,points.cols());
+
+		data.resize(points.rows(),points.cols());
+		for (IndexType i=0; i<points.cols(); ++i)
+			data.col(i) = points.col(indices[i]);
+	}
+
+	//! Finds k nearest neighbors of the provided vector
+	//!
+	//! @param query feature vector
+	//! @param candidates storage for nearest candidates
+	//!
+	template <class VectorType>
+	void search(const VectorType& query, NearestCandidates& candidates) const
+	{
+		if (!nodes.empty())
+			search(0,query,candidates);
+	}
+
+	//! Finds k nearest neighbors of each of stored points
+	//!
+	//! @param k number of neighbors
+	//!
+	Neighbors all_neighbors(IndexType k) const
+	{
+		const IndexType n = data.cols();
+		Neighbors neighbors(n);
+#pragma omp parallel for schedule(dynamic,256)
+		for (IndexType i=0; i<n; ++i)
+		{
+			NearestCandidates candidates(k+1);
+			search(0,data.col(i),candidates);
+			neighbors[indices[i]] = candidates.neighbors_except(indices[i]);
+		}
+		return neighbors;
+	}
+
+private:
+
+	struct Node
+	{
+		Node(IndexType b, IndexType e) :
+			begin(b), end(e), radius(0.0), left(-1), right(-1)
+		{
+		}
+		//! range of points in the node
+		IndexType begin, end;
+		//! radius of the ball
+		ScalarType radius;
+		//! children, -1 for leaves
+		IndexType left, right;
+	};
+
+	struct ProjectionComparator
+	{
+		ProjectionComparator(const DenseVector& p) : projections(p) {}
+		inline bool operator()(IndexType a, IndexType b) const
+		{
+			return projections(a) < projections(b);
+		}
+		const DenseVector& projections;
+	};
+
+	IndexType farthest(const DenseMatrix& points, IndexType begin, IndexType end, const DenseVector& from) const
+	{
+		IndexType result = begin;
+		ScalarType largest = -1.0;
+		for (IndexType i=begin; i<end; ++i)
+		{
+			ScalarType distance = (points.col(indices[i]) - from).squaredNorm();
+			if (distance > largest)
+			{
+				largest = distance;
+				result = i;
+			}
+		}
+		return result;
+	}
+
+	IndexType build(const DenseMatrix& points, DenseVector& projections, IndexType begin, IndexType end)
+	{
+		IndexType id = nodes.size();
+		nodes.push_back(Node(begin,end));
+		if (id >= centers.cols())
+			centers.conservativeResize(Eigen::NoChange,2*id);
+
+		DenseVector center = DenseVector::Zero(points.rows());
+		for (IndexType i=begin; i<end; ++i)
+			center += points.col(indices[i]);
+		center /= (end-begin);
+		centers.col(id) = center;
+
+		ScalarType radius = 0.0;
+		for (IndexType i=begin; i<end; ++i)
+			radius = std::max(radius,(points.col(indices[i]) - center).squaredNorm());
+		nodes[id].radius = std::sqrt(radius);
+
+		if (end - begin <= bucket || radius == 0.0)
+			return id;
+
+		// direction between two distant points of the node
+		DenseVector a = points.col(indices[farthest(points,begin,end,center)]);
+		DenseVector b = points.col(indices[farthest(points,begin,end,a)]);
+		DenseVector direction = b - a;
+
+		for (IndexType i=begin; i<end; ++i)
+			projections(indices[i]) = points.col(indices[i]).dot(direction);
+
+		IndexType median = (begin + end)/2;
+		std::nth_element(indices.begin()+begin,indices.begin()+median,indices.begin()+end,
+		                 ProjectionComparator(projections));
+		IndexType left = build(points,projections,begin,median);
+		IndexType right = build(points,projections,median,end);
+		nodes[id].left = left;
+		nodes[id].right = right;
+		return id;
+	}
+
+	template <class VectorType>
+	inline ScalarType ball_distance(IndexType id, const VectorType& query) const
+	{
+		ScalarType distance = std::max(ScalarType(0.0),(centers.col(id) - query).norm() - nodes[id].radius);
+		return distance*distance;
+	}
+
+	template <class VectorType>
+	void search(IndexType id, const VectorType& query, NearestCandidates& candidates) const
+	{
+		const Node& node = nodes[id];
+		if (node.left == -1)
+		{
+			for (IndexType i=node.begin; i<node.end; ++i)
+				candidates.push(bounded_squared_euclidean_distance(data.col(i),query,candidates.bound()),indices[i]);
+			return;
+		}
+
+		IndexType near = node.left;
+		IndexType far = node.right;
+		ScalarType near_distance = ball_distance(near,query);
+		ScalarType far_distance = ball_distance(far,query);
+		if (far_distance < near_distance)
+		{
+			std::swap(near,far);
+			std::swap(near_distance,far_distance);
+		}
+		if (near_distance < candidates.bound())
+			search(near,query,candidates);
+		if (far_distance < candidates.bound())
+			search(far,query,candidates);
+	}
+
+	//! points in the tree order
+	DenseMatrix data;
+	//! original indices of points in the tree order
+	std::vector<IndexType> indices;
+	std::vector<Node> nodes;
+	//! centers of balls
+	DenseMatrix centers;
+	IndexType bucket;
+};
+
+} // End of namespace tapkee_internal
+} // End of namespace tapkee
+
+#endif
@@ -16,6 +16,7 @@
 
 #include <cmath>
 #include <limits>
+#include <vector>
 #include <stdio.h>
 #include <assert.h>
 
@@ -29,19 +30,20 @@ namespace tapkee_internal
 {
 
 /**
- * Cover tree node TODO better doc
+ * Cover tree node as it is built. Once all siblings are built
+ * they are committed to the @ref cover_tree storage.
  */
 template<class P>
 struct node 
 {
 	node() : p(), max_dist(0.0), parent_dist(0.0), 
-		children(NULL), num_children(0), scale(0) 
+		first_child(0), num_children(0), scale(0) 
 	{
 	}
 
-	node(P _p, ScalarType _max_dist, ScalarType _parent_dist, node<P>* _children,
-	     unsigned short int _num_children, short int _scale) : p(_p), 
-		max_dist(_max_dist), parent_dist(_parent_dist), children(_children),
+	node(P _p, ScalarType _max_dist, ScalarType _parent_dist, IndexType _first_child,
+	     IndexType _num_children, short int _scale) : p(_p), 
+		max_dist(_max_dist), parent_dist(_parent_dist), first_child(_first_child),
 		num_children(_num_children), scale(_scale) 
 	{
 	}
@@ -55,26 +57,85 @@ struct node
 	/** The distance to the parent */
 	ScalarType parent_dist;
 
-	/** Pointer to the list of children of this node */
-	node<P>* children;
+	/** Index of the first child of this node in the tree storage */
+	IndexType first_child;
 
 	/** The number of children nodes of this node */
-	unsigned short int num_children;
+	IndexType num_children;
 
 	/** Essentially, an upper bound on the distance to any child */
 	short int scale;
 };
 
+/**
+ * Cover tree stored in one arena as a structure of arrays. Nodes 
+ * are referred by indices and children of each node occupy 
+ * a contiguous range of indices so queries walk contiguous memory.
+ * The storage is reserved once for the maximal number of nodes 
+ * (every internal node has at least two children, so there are 
+ * less than twice as many nodes as points).
+ */
 template<class P>
-void free_children(const node<P>& n)
+struct cover_tree
 {
-	for (int i=0; i<n.num_children; i++)
+	cover_tree() : points(), max_dist(), parent_dist(), first_child(), 
+		num_children(), scale(), root(0), siblings()
 	{
-		free_children<P>(n.children[i]);
-		n.children[i].~node<P>();
 	}
-	free(n.children);
-}
+
+	/** Reserves storage for the tree over the provided number of points */
+	void reserve(IndexType n_points)
+	{
+		const IndexType n_nodes = 2*n_points;
+		points.reserve(n_nodes);
+		max_dist.reserve(n_nodes);
+		parent_dist.reserve(n_nodes);
+		first_child.reserve(n_nodes);
+		num_children.reserve(n_nodes);
+		scale.reserve(n_nodes);
+		siblings.reserve(n_points);
+	}
+
+	/** Stores the node and returns its index */
+	IndexType commit(const node<P>& n)
+	{
+		points.push_back(n.p);
+		max_dist.push_back(n.max_dist);
+		parent_dist.push_back(n.parent_dist);
+		first_child.push_back(n.first_child);
+		num_children.push_back(n.num_children);
+		scale.push_back(n.scale);
+		return points.size()-1;
+	}
+
+	/** Stores siblings pushed since the provided position contiguously
+	 *  and returns index of the first one */
+	IndexType commit_siblings(IndexType begin)
+	{
+		IndexType first = points.size();
+		for (IndexType i=begin; i<static_cast<IndexType>(siblings.size()); ++i)
+			commit(siblings[i]);
+		siblings.resize(begin);
+		return first;
+	}
+
+	/** Points of nodes */
+	std::vector<P> points;
+	/** The maximum distance to any grandchild */
+	std::vector<ScalarType> max_dist;
+	/** The distance to the parent */
+	std::vector<ScalarType> parent_dist;
+	/** Indices of first children */
+	std::vector<IndexType> first_child;
+	/** Numbers of children */
+	std::vector<IndexType> num_children;
+	/** Essentially, an upper bound on the distance to any child */
+	std::vector<short int> scale;
+	/** Index of the root */
+	IndexType root;
+	/** Stack of built nodes waiting for their siblings */
+	std::vector<node<P> > siblings;
+};
 
 
 /**
@@ -116,7 +177,7 @@ node<P> new_node(const P &p)
 	template<class P>
 node<P> new_leaf(const P &p)
 {
-	node<P> new_leaf(p,0.,0.,NULL,0,100);
+	node<P> new_leaf(p,0.,0.,0,0,100);
 	return new_leaf;
 }
 
@@ -137,20 +198,20 @@ void print_space(int s)
 }
 
 template<class P>
-void print(int depth, node<P> &top_node)
+void print(int depth, const cover_tree<P>& tree, IndexType top_node)
 {
 	print_space(depth);
-	print(top_node.p);
-	if ( top_node.num_children > 0 ) 
+	print(tree.points[top_node]);
+	if ( tree.num_children[top_node] > 0 ) 
 	{
 		print_space(depth); 
-		printf("scale = %i\n",top_node.scale);
+		printf("scale = %i\n",tree.scale[top_node]);
 		print_space(depth); 
-		printf("max_dist = %f\n",top_node.max_dist);
+		printf("max_dist = %f\n",tree.max_dist[top_node]);
 		print_space(depth); 
-		printf("num children = %i\n",top_node.num_children);
-		for (int i = 0; i < top_node.num_children;i++)
-			print(depth+1, top_node.children[i]);
+		printf("num children = %i\n",tree.num_children[top_node]);
+		for (int i = 0; i < tree.num_children[top_node];i++)
+			print(depth+1, tree, tree.first_child[top_node]+i);
 	}
 }
 
@@ -199,7 +260,7 @@ void dist_split(DistanceCallback& dcb, v_array<ds_node<P> >& point_set,
    point_set contains points which are 2*max_scale or less away.
    */
 template <class P, class DistanceCallback>
-node<P> batch_insert(DistanceCallback& dcb, const P& p,
+node<P> batch_insert(DistanceCallback& dcb, cover_tree<P>& tree, const P& p,
 		int max_scale, 
 		int top_scale,
 		v_array<ds_node<P> >& point_set, 
@@ -213,20 +274,19 @@ node<P> batch_insert(DistanceCallback& dcb, const P& p,
 		int next_scale = std::min(max_scale - 1, get_scale(max_dist));
 		if (next_scale == -2147483647-1) // We have points with distance 0.
 		{
-			v_array<node<P> > children;
-			push(children,new_leaf(p));
+			IndexType siblings_begin = tree.siblings.size();
+			tree.siblings.push_back(new_leaf(p));
 			while (point_set.index > 0)
 			{
-				push(children,new_leaf(point_set.last().p));
+				tree.siblings.push_back(new_leaf(point_set.last().p));
 				push(consumed_set,point_set.last());
 				point_set.decr();
 			}
 			node<P> n = new_node(p);
 			n.scale = 100; // A magic number meant to be larger than all scales.  
 			n.max_dist = 0;
-			alloc(children,children.index);
-			n.num_children = children.index;
-			n.children = children.elements;
+			n.num_children = tree.siblings.size() - siblings_begin;
+			n.first_child = tree.commit_siblings(siblings_begin);
 			return n;
 		}
 		else
@@ -234,7 +294,7 @@ node<P> batch_insert(DistanceCallback& dcb, const P& p,
 			v_array<ds_node<P> > far = pop(stack);
 			split(point_set,far,max_scale); //O(|point_set|)
 
-			node<P> child = batch_insert(dcb, p, next_scale, top_scale, point_set, consumed_set, stack);
+			node<P> child = batch_insert(dcb, tree, p, next_scale, top_scale, point_set, consumed_set, stack);
 
 			if (point_set.index == 0)
 			{
@@ -244,8 +304,10 @@ node<P> batch_insert(DistanceCallback& dcb, const P& p,
 			}
 			else {
 				node<P> n = new_node(p);
-				v_array<node<P> > children;
-				push(children, child);
+				// children are built depth-first, siblings wait on the stack 
+				// until all of them are built and then are stored contiguously
+				IndexType siblings_begin = tree.siblings.size();
+				tree.siblings.push_back(child);
 				v_array<ds_node<P> > new_point_set = pop(stack);
 				v_array<ds_node<P> > new_consumed_set = pop(stack);
 				while (point_set.index != 0) { //O(|point_set| * num_children)
@@ -258,10 +320,10 @@ node<P> batch_insert(DistanceCallback& dcb, const P& p,
 					dist_split(dcb,far,new_point_set,new_point,max_scale); //O(|far|)
 
 					node<P> new_child = 
-						batch_insert(dcb, new_point, next_scale, top_scale, new_point_set, new_consumed_set, stack);
+						batch_insert(dcb, tree, new_point, next_scale, top_scale, new_point_set, new_consumed_set, stack);
 					new_child.parent_dist = new_dist;
 
-					push(children, new_child);
+					tree.siblings.push_back(new_child);
 
 					ScalarType fmax = dist_of_scale(max_scale);
 					for(int i = 0; i< new_point_set.index; i++) //O(|new_point_set|)
@@ -286,9 +348,8 @@ node<P> batch_insert(DistanceCallback& dcb, const P& p,
 				point_set=far;
 				n.scale = top_scale - max_scale;
 				n.max_dist = max_set(consumed_set);
-				alloc(children,children.index);
-				n.num_children = children.index;
-				n.children = children.elements;
+				n.num_children = tree.siblings.size() - siblings_begin;
+				n.first_child = tree.commit_siblings(siblings_begin);
 				return n;
 			}
 		}
@@ -296,11 +357,13 @@ node<P> batch_insert(DistanceCallback& dcb, const P& p,
 }
 
 template<class P, class DistanceCallback>
-node<P> batch_create(DistanceCallback& dcb, v_array<P> points)
+void batch_create(DistanceCallback& dcb, v_array<P> points, cover_tree<P>& tree)
 {
 	assert(points.index > 0);
+	tree.reserve(points.index);
 	v_array<ds_node<P> > point_set;
 	v_array<v_array<ds_node<P> > > stack;
+	alloc(point_set, points.index);
 
 	for (int i = 1; i < points.index; i++) {
 		ds_node<P> temp;
@@ -313,7 +376,7 @@ node<P> batch_create(DistanceCallback& dcb, v_array<P> points)
 
 	ScalarType max_dist = max_set(point_set);
 
-	node<P> top = batch_insert (dcb, points[0],
+	node<P> top = batch_insert (dcb, tree, points[0],
 			get_scale(max_dist),
 			get_scale(max_dist),
 			point_set, 
@@ -326,7 +389,7 @@ node<P> batch_create(DistanceCallback& dcb, v_array<P> points)
 		free(stack[i].elements);
 	free(stack.elements);
 	free(point_set.elements);
-	return top;
+	tree.root = tree.commit(top);
 }
 
 void add_height(int d, v_array<int> &heights)
@@ -338,9 +401,9 @@ void add_height(int d, v_array<int> &heights)
 }
 
 template <class P>
-int height_dist(const node<P> top_node,v_array<int> &heights)
+int height_dist(const cover_tree<P>& tree, IndexType top_node, v_array<int> &heights)
 {
-	if (top_node.num_children == 0)
+	if (tree.num_children[top_node] == 0)
 	{
 		add_height(0,heights);
 		return 0;
@@ -348,9 +411,9 @@ int height_dist(const node<P> top_node,v_array<int> &heights)
 	else
 	{
 		int max_v=0;
-		for (int i = 0; i<top_node.num_children ;i++)
+		for (int i = 0; i<tree.num_children[top_node] ;i++)
 		{
-			int d = height_dist(top_node.children[i], heights);
+			int d = height_dist(tree, tree.first_child[top_node]+i, heights);
 			if (d > max_v)
 				max_v = d;
 		}
@@ -360,26 +423,26 @@ int height_dist(const node<P> top_node,v_array<int> &heights)
 }
 
 template <class P>
-void depth_dist(int top_scale, const node<P> top_node,v_array<int> &depths)
+void depth_dist(int top_scale, const cover_tree<P>& tree, IndexType top_node, v_array<int> &depths)
 {
-	if (top_node.num_children > 0)
-		for (int i = 0; i<top_node.num_children ;i++)
+	if (tree.num_children[top_node] > 0)
+		for (int i = 0; i<tree.num_children[top_node] ;i++)
 		{
-			add_height(top_node.scale, depths);
-			depth_dist(top_scale, top_node.children[i], depths);
+			add_height(tree.scale[top_node], depths);
+			depth_dist(top_scale, tree, tree.first_child[top_node]+i, depths);
 		}
 }
 
 template <class P>
-void breadth_dist(const node<P> top_node,v_array<int> &breadths)
+void breadth_dist(const cover_tree<P>& tree, IndexType top_node, v_array<int> &breadths)
 {
-	if (top_node.num_children == 0)
+	if (tree.num_children[top_node] == 0)
 		add_height(0,breadths);
 	else
 	{
-		for (int i = 0; i<top_node.num_children ;i++)
-			breadth_dist(top_node.children[i], breadths);
-		add_height(top_node.num_children, breadths);
+		for (int i = 0; i<tree.num_children[top_node] ;i++)
+			breadth_dist(tree, tree.first_child[top_node]+i, breadths);
+		add_height(tree.num_children[top_node], breadths);
 	}
 }
 
@@ -392,8 +455,8 @@ struct d_node
 	/** Distance TODO better doc*/
 	ScalarType dist;
 
-	/** List of nodes TODO better doc*/
-	const node<P> *n;
+	/** Index of the node in the tree */
+	IndexType n;
 };
 
 template <class P>
@@ -532,7 +595,8 @@ void (*setter)(ScalarType *foo, ScalarType bar) = set_k;
 ScalarType* (*alloc_upper)() = alloc_k;
 
 template <class P, class DistanceCallback>
-inline void copy_zero_set(DistanceCallback& dcb, node<P>* query_chi,
+inline void copy_zero_set(DistanceCallback& dcb, const cover_tree<P>& tree,
+		const cover_tree<P>& query_tree, IndexType query_chi,
 		ScalarType* new_upper_bound, v_array<d_node<P> > &zero_set,
 		v_array<d_node<P> > &new_zero_set)
 {
@@ -540,10 +604,10 @@ inline void copy_zero_set(DistanceCallback& dcb, node<P>* query_chi,
 	d_node<P> *end = zero_set.elements + zero_set.index;
 	for (d_node<P> *ele = zero_set.elements; ele != end ; ele++)
 	{
-		ScalarType upper_dist = *new_upper_bound + query_chi->max_dist;
-		if (shell(ele->dist, query_chi->parent_dist, upper_dist))
+		ScalarType upper_dist = *new_upper_bound + query_tree.max_dist[query_chi];
+		if (shell(ele->dist, query_tree.parent_dist[query_chi], upper_dist))
 		{
-			ScalarType d = distance(dcb, query_chi->p, ele->n->p, upper_dist);
+			ScalarType d = distance(dcb, query_tree.points[query_chi], tree.points[ele->n], upper_dist);
 
 			if (d <= upper_dist)
 			{
@@ -557,7 +621,8 @@ inline void copy_zero_set(DistanceCallback& dcb, node<P>* query_chi,
 }
 
 template <class P, class DistanceCallback>
-inline void copy_cover_sets(DistanceCallback& dcb, node<P>* query_chi,
+inline void copy_cover_sets(DistanceCallback& dcb, const cover_tree<P>& tree,
+		const cover_tree<P>& query_tree, IndexType query_chi,
 		ScalarType* new_upper_bound,
 		v_array<v_array<d_node<P> > > &cover_sets,
 		v_array<v_array<d_node<P> > > &new_cover_sets,
@@ -569,10 +634,10 @@ inline void copy_cover_sets(DistanceCallback& dcb, node<P>* query_chi,
 		d_node<P>* end = cover_sets[current_scale].elements + cover_sets[current_scale].index;
 		for (; ele != end; ele++)
 		{ 
-			ScalarType upper_dist = *new_upper_bound + query_chi->max_dist + ele->n->max_dist;
-			if (shell(ele->dist, query_chi->parent_dist, upper_dist))
+			ScalarType upper_dist = *new_upper_bound + query_tree.max_dist[query_chi] + tree.max_dist[ele->n];
+			if (shell(ele->dist, query_tree.parent_dist[query_chi], upper_dist))
 			{
-				ScalarType d = distance(dcb, query_chi->p, ele->n->p, upper_dist);
+				ScalarType d = distance(dcb, query_tree.points[query_chi], tree.points[ele->n], upper_dist);
 
 				if (d <= upper_dist)
 				{
@@ -587,19 +652,20 @@ inline void copy_cover_sets(DistanceCallback& dcb, node<P>* query_chi,
 }
 
 template <class P>
-void print_query(const node<P> *top_node)
+void print_query(const cover_tree<P>& query_tree, IndexType top_node)
 {
 	printf("query = \n");
-	print(top_node->p);
-	if ( top_node->num_children > 0 ) {
-		printf("scale = %i\n",top_node->scale);
-		printf("max_dist = %f\n",top_node->max_dist);
-		printf("num children = %i\n",top_node->num_children);
+	print(query_tree.points[top_node]);
+	if ( query_tree.num_children[top_node] > 0 ) {
+		printf("scale = %i\n",query_tree.scale[top_node]);
+		printf("max_dist = %f\n",query_tree.max_dist[top_node]);
+		printf("num children = %i\n",query_tree.num_children[top_node]);
 	}
 }
 
 template <class P>
-void print_cover_sets(v_array<v_array<d_node<P> > > &cover_sets,
+void print_cover_sets(const cover_tree<P>& tree, 
+		v_array<v_array<d_node<P> > > &cover_sets,
 		v_array<d_node<P> > &zero_set,
 		int current_scale, int max_scale)
 {
@@ -610,18 +676,12 @@ void print_cover_sets(v_array<v_array<d_node<P> > > &cover_sets,
 		d_node<P> *end = cover_sets[current_scale].elements + cover_sets[current_scale].index;
 		printf("%i\n", current_scale);
 		for (; ele != end; ele++)
-		{
-			node<P> *n = (node<P> *)ele->n;
-			print(n->p);
-		}
+			print(tree.points[ele->n]);
 	}
 	d_node<P> *end = zero_set.elements + zero_set.index;
 	printf("infinity\n");
 	for (d_node<P> *ele = zero_set.elements; ele != end ; ele++)
-	{
-		node<P> *n = (node<P> *)ele->n;
-		print(n->p);
-	}
+		print(tree.points[ele->n]);
 }
 
 /*
@@ -637,26 +697,28 @@ void print_cover_sets(v_array<v_array<d_node<P> > > &cover_sets,
    */
 template <class P, class DistanceCallback>
 inline 
-void descend(DistanceCallback& dcb, const node<P>* query, ScalarType* upper_bound,
+void descend(DistanceCallback& dcb, const cover_tree<P>& tree, 
+		const cover_tree<P>& query_tree, IndexType query, ScalarType* upper_bound,
 		int current_scale,int &max_scale, v_array<v_array<d_node<P> > > &cover_sets,
 		v_array<d_node<P> > &zero_set)
 {
+	const ScalarType query_max_dist = query_tree.max_dist[query];
 	d_node<P> *end = cover_sets[current_scale].elements + cover_sets[current_scale].index;
 	for (d_node<P> *parent = cover_sets[current_scale].elements; parent != end; parent++)
 	{
-		const node<P> *par = parent->n;
-		ScalarType upper_dist = *upper_bound + query->max_dist + query->max_dist;
-		if (parent->dist <= upper_dist + par->max_dist)
+		IndexType par = parent->n;
+		ScalarType upper_dist = *upper_bound + query_max_dist + query_max_dist;
+		if (parent->dist <= upper_dist + tree.max_dist[par])
 		{
-			node<P> *chi = par->children;
-			if (parent->dist <= upper_dist + chi->max_dist)
+			IndexType chi = tree.first_child[par];
+			if (parent->dist <= upper_dist + tree.max_dist[chi])
 			{
-				if (chi->num_children > 0)
+				if (tree.num_children[chi] > 0)
 				{
-					if (max_scale < chi->scale)
-						max_scale = chi->scale;
+					if (max_scale < tree.scale[chi])
+						max_scale = tree.scale[chi];
 					d_node<P> temp = {parent->dist, chi};
-					push(cover_sets[chi->scale], temp);
+					push(cover_sets[tree.scale[chi]], temp);
 				}
 				else if (parent->dist <= upper_dist)
 				{
@@ -664,26 +726,26 @@ void descend(DistanceCallback& dcb, const node<P>* query, ScalarType* upper_boun
 					push(zero_set, temp);
 				}
 			}
-			node<P> *child_end = par->children + par->num_children;
+			IndexType child_end = tree.first_child[par] + tree.num_children[par];
 			for (chi++; chi != child_end; chi++)
 			{
-				ScalarType upper_chi = *upper_bound + chi->max_dist + query->max_dist + query->max_dist;
-				if (shell(parent->dist, chi->parent_dist, upper_chi))
+				ScalarType upper_chi = *upper_bound + tree.max_dist[chi] + query_max_dist + query_max_dist;
+				if (shell(parent->dist, tree.parent_dist[chi], upper_chi))
 				{
-					ScalarType d = distance(dcb, query->p, chi->p, upper_chi);
+					ScalarType d = distance(dcb, query_tree.points[query], tree.points[chi], upper_chi);
 					if (d <= upper_chi) 
 					{
 						if (d < *upper_bound)
 							update(upper_bound, d);
-						if (chi->num_children > 0)
+						if (tree.num_children[chi] > 0)
 						{
-							if (max_scale < chi->scale)
-								max_scale = chi->scale;
+							if (max_scale < tree.scale[chi])
+								max_scale = tree.scale[chi];
 							d_node<P> temp = {d, chi};
-							push(cover_sets[chi->scale],temp);
+							push(cover_sets[tree.scale[chi]],temp);
 						}
 						else 
-							if (d <= upper_chi - chi->max_dist)
+							if (d <= upper_chi - tree.max_dist[chi])
 							{
 								d_node<P> temp = {d, chi};
 								push(zero_set, temp);
@@ -696,24 +758,25 @@ void descend(DistanceCallback& dcb, const node<P>* query, ScalarType* upper_boun
 }
 
 template <class P, class DistanceCallback>
-void brute_nearest(DistanceCallback& dcb, const node<P>* query,
+void brute_nearest(DistanceCallback& dcb, const cover_tree<P>& tree,
+		const cover_tree<P>& query_tree, IndexType query,
 		v_array<d_node<P> > zero_set, ScalarType* upper_bound,
 		v_array<v_array<P> > &results,
 		v_array<v_array<d_node<P> > > &spare_zero_sets)
 {
-	if (query->num_children > 0)
+	if (query_tree.num_children[query] > 0)
 	{
 		v_array<d_node<P> > new_zero_set = pop(spare_zero_sets);
-		node<P> * query_chi = query->children; 
-		brute_nearest(dcb, query_chi, zero_set, upper_bound, results, spare_zero_sets);
+		IndexType query_chi = query_tree.first_child[query]; 
+		brute_nearest(dcb, tree, query_tree, query_chi, zero_set, upper_bound, results, spare_zero_sets);
 		ScalarType* new_upper_bound = alloc_upper();
 
-		node<P> *child_end = query->children + query->num_children;
+		IndexType child_end = query_tree.first_child[query] + query_tree.num_children[query];
 		for (query_chi++;query_chi != child_end; query_chi++)
 		{
-			setter(new_upper_bound,*upper_bound + query_chi->parent_dist);
-			copy_zero_set(dcb, query_chi, new_upper_bound, zero_set, new_zero_set);
-			brute_nearest(dcb, query_chi, new_zero_set, new_upper_bound, results, spare_zero_sets);
+			setter(new_upper_bound,*upper_bound + query_tree.parent_dist[query_chi]);
+			copy_zero_set(dcb, tree, query_tree, query_chi, new_upper_bound, zero_set, new_zero_set);
+			brute_nearest(dcb, tree, query_tree, query_chi, new_zero_set, new_upper_bound, results, spare_zero_sets);
 		}
 		free (new_upper_bound);
 		new_zero_set.index = 0;
@@ -722,17 +785,18 @@ void brute_nearest(DistanceCallback& dcb, const node<P>* query,
 	else 
 	{
 		v_array<P> temp;
-		push(temp, query->p);
+		push(temp, query_tree.points[query]);
 		d_node<P> *end = zero_set.elements + zero_set.index;
 		for (d_node<P> *ele = zero_set.elements; ele != end ; ele++)
 			if (ele->dist <= *upper_bound) 
-				push(temp, ele->n->p);
+				push(temp, tree.points[ele->n]);
 		push(results,temp);
 	}
 }
 
 template <class P, class DistanceCallback>
-void internal_batch_nearest_neighbor(DistanceCallback& dcb, const node<P> *query,
+void internal_batch_nearest_neighbor(DistanceCallback& dcb, const cover_tree<P>& tree,
+		const cover_tree<P>& query_tree, IndexType query,
 		v_array<v_array<d_node<P> > > &cover_sets,
 		v_array<d_node<P> > &zero_set,
 		int current_scale,
@@ -743,24 +807,24 @@ void internal_batch_nearest_neighbor(DistanceCallback& dcb, const node<P> *query
 		v_array<v_array<d_node<P> > > &spare_zero_sets)
 {
 	if (current_scale > max_scale) // All remaining points are in the zero set. 
-		brute_nearest(dcb, query, zero_set, upper_bound, results, spare_zero_sets);
+		brute_nearest(dcb, tree, query_tree, query, zero_set, upper_bound, results, spare_zero_sets);
 	else
-		if (query->scale <= current_scale && query->scale != 100) 
+		if (query_tree.scale[query] <= current_scale && query_tree.scale[query] != 100) 
 			// Our query has too much scale.  Reduce.
 		{ 
-			node<P> *query_chi = query->children;
+			IndexType query_chi = query_tree.first_child[query];
 			v_array<d_node<P> > new_zero_set = pop(spare_zero_sets);
 			v_array<v_array<d_node<P> > > new_cover_sets = get_cover_sets(spare_cover_sets);
 			ScalarType* new_upper_bound = alloc_upper();
 
-			node<P> *child_end = query->children + query->num_children;
+			IndexType child_end = query_tree.first_child[query] + query_tree.num_children[query];
 			for (query_chi++; query_chi != child_end; query_chi++)
 			{
-				setter(new_upper_bound,*upper_bound + query_chi->parent_dist);
-				copy_zero_set(dcb, query_chi, new_upper_bound, zero_set, new_zero_set);
-				copy_cover_sets(dcb, query_chi, new_upper_bound, cover_sets, new_cover_sets,
+				setter(new_upper_bound,*upper_bound + query_tree.parent_dist[query_chi]);
+				copy_zero_set(dcb, tree, query_tree, query_chi, new_upper_bound, zero_set, new_zero_set);
+				copy_cover_sets(dcb, tree, query_tree, query_chi, new_upper_bound, cover_sets, new_cover_sets,
 						current_scale, max_scale);
-				internal_batch_nearest_neighbor(dcb, query_chi, new_cover_sets, new_zero_set,
+				internal_batch_nearest_neighbor(dcb, tree, query_tree, query_chi, new_cover_sets, new_zero_set,
 						current_scale, max_scale, new_upper_bound, 
 						results, spare_cover_sets, spare_zero_sets);
 			}
@@ -768,24 +832,24 @@ void internal_batch_nearest_neighbor(DistanceCallback& dcb, const node<P> *query
 			new_zero_set.index = 0;
 			push(spare_zero_sets, new_zero_set);
 			push(spare_cover_sets, new_cover_sets);
-			internal_batch_nearest_neighbor(dcb, query->children, cover_sets, zero_set,
-					current_scale, max_scale, upper_bound, results, 
+			internal_batch_nearest_neighbor(dcb, tree, query_tree, query_tree.first_child[query], 
+					cover_sets, zero_set, current_scale, max_scale, upper_bound, results, 
 					spare_cover_sets, spare_zero_sets);
 		}
 		else // reduce cover set scale
 		{
 			halfsort(cover_sets[current_scale]);
-			descend(dcb, query, upper_bound, current_scale, max_scale,cover_sets, zero_set);
+			descend(dcb, tree, query_tree, query, upper_bound, current_scale, max_scale,cover_sets, zero_set);
 			cover_sets[current_scale++].index = 0;
-			internal_batch_nearest_neighbor(dcb, query, cover_sets, zero_set,
+			internal_batch_nearest_neighbor(dcb, tree, query_tree, query, cover_sets, zero_set,
 					current_scale, max_scale, upper_bound, results, 
 					spare_cover_sets, spare_zero_sets);
 		}
 }
 
 template <class P, class DistanceCallback>
-void batch_nearest_neighbor(DistanceCallback &dcb, const node<P> &top_node,
-		const node<P> &query, v_array<v_array<P> > &results)
+void batch_nearest_neighbor(DistanceCallback &dcb, const cover_tree<P> &tree,
+		const cover_tree<P> &query_tree, v_array<v_array<P> > &results)
 {
 	v_array<v_array<v_array<d_node<P> > > > spare_cover_sets;
 	v_array<v_array<d_node<P> > > spare_zero_sets;
@@ -796,13 +860,14 @@ void batch_nearest_neighbor(DistanceCallback &dcb, const node<P> &top_node,
 	ScalarType* upper_bound = alloc_upper();
 	setter(upper_bound, std::numeric_limits<ScalarType>::max());
 
-	ScalarType top_dist = distance(dcb, query.p, top_node.p, std::numeric_limits<ScalarType>::max());
+	ScalarType top_dist = distance(dcb, query_tree.points[query_tree.root], tree.points[tree.root], 
+			std::numeric_limits<ScalarType>::max());
 	update(upper_bound, top_dist);
 
-	d_node<P> temp = {top_dist, &top_node};
+	d_node<P> temp = {top_dist, tree.root};
 	push(cover_sets[0], temp);
 
-	internal_batch_nearest_neighbor(dcb, &query,cover_sets,zero_set,0,0,upper_bound,results,
+	internal_batch_nearest_neighbor(dcb, tree, query_tree, query_tree.root, cover_sets,zero_set,0,0,upper_bound,results,
 			spare_cover_sets,spare_zero_sets);
 
 	free(upper_bound);
@@ -825,20 +890,20 @@ void batch_nearest_neighbor(DistanceCallback &dcb, const node<P> &top_node,
 }
 
 template <class P, class DistanceCallback>
-void k_nearest_neighbor(DistanceCallback &dcb, const node<P> &top_node,
-		const node<P> &query, v_array<v_array<P> > &results, int k)
+void k_nearest_neighbor(DistanceCallback &dcb, const cover_tree<P> &tree,
+		const cover_tree<P> &query_tree, v_array<v_array<P> > &results, int k)
 {
 	internal_k = k;
 	update = update_k;
 	setter = set_k;
 	alloc_upper = alloc_k;
 
-	batch_nearest_neighbor(dcb, top_node, query, results);
+	batch_nearest_neighbor(dcb, tree, query_tree, results);
 }
 /*
 template <class P, class DistanceCallback>
-void epsilon_nearest_neighbor(DistanceCallback &dcb, const node<P> &top_node,
-		const node<P> &query, v_array<v_array<P> > &results,
+void epsilon_nearest_neighbor(DistanceCallback &dcb, const cover_tree<P> &tree,
+		const cover_tree<P> &query_tree, v_array<v_array<P> > &results,
 		ScalarType epsilon)
 {
 	internal_epsilon = epsilon;
@@ -846,18 +911,18 @@ void epsilon_nearest_neighbor(DistanceCallback &dcb, const node<P> &top_node,
 	setter = set_epsilon;
 	alloc_upper = alloc_epsilon;
 
-	batch_nearest_neighbor(dcb, top_node, query, results);
+	batch_nearest_neighbor(dcb, tree, query_tree, results);
 }
 
 template <class P, class DistanceCallback>
-void unequal_nearest_neighbor(DistanceCallback &dcb, const node<P> &top_node,
-		const node<P> &query, v_array<v_array<P> > &results)
+void unequal_nearest_neighbor(DistanceCallback &dcb, const cover_tree<P> &tree,
+		const cover_tree<P> &query_tree, v_array<v_array<P> > &results)
 {
 	update = update_unequal;
 	setter = set_unequal;
 	alloc_upper = alloc_unequal;
 
-	batch_nearest_neighbor(dcb, top_node, query, results);
+	batch_nearest_neighbor(dcb, tree, query_tree, results);
 }
 */
 
@@ -131,8 +131,6 @@ template <class RandomAccessIterator, class Callback>
 inline ScalarType distance(Callback& cb, const CoverTreePoint<RandomAccessIterator>& l,
 		const CoverTreePoint<RandomAccessIterator>& r, ScalarType upper_bound)
 {
-	//assert(upper_bound>=0);
-
 	if (l.iter_==r.iter_)
 		return 0.0;
 
@@ -157,9 +155,9 @@ template <class RandomAccessIterator, class Callback>
 struct distance_impl<DistanceType,RandomAccessIterator,Callback>
 {
 	inline ScalarType operator()(Callback& cb, const CoverTreePoint<RandomAccessIterator>& l,
-                                 const CoverTreePoint<RandomAccessIterator>& r, ScalarType /*upper_bound*/)
+                                 const CoverTreePoint<RandomAccessIterator>& r, ScalarType upper_bound)
 	{
-		return cb(l.iter_,r.iter_);
+		return cb.distance_bounded(l.iter_,r.iter_,upper_bound);
 	}
 };
 
@@ -0,0 +1,256 @@
+/* This software is distributed under BSD 3-clause license (see LICENSE file).
+ *
+ * Copyright (c) 2012-2013 Sergey Lisitsyn
+ */
+
+#ifndef TAPKEE_KDTREE_H_
+#define TAPKEE_KDTREE_H_
+
+/* Tapkee includes */
+#include <tapkee/defines.hpp>
+#include <tapkee/utils/distance.hpp>
+/* End of Tapkee includes */
+
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include <limits>
+
+namespace tapkee
+{
+namespace tapkee_internal
+{
+
+//! Bounded max-heap of (squared distance, index) pairs that keeps
+//! k nearest candidates found so far.
+class NearestCandidates
+{
+public:
+	typedef std::pair<ScalarType,IndexType> Candidate;
+
+	NearestCandidates(IndexType k) : heap(), capacity(k)
+	{
+	}
+	//! Returns squared distance any new candidate should be closer than
+	inline ScalarType bound() const
+	{
+		return (static_cast<IndexType>(heap.size()) < capacity) ?
+			std::numeric_limits<ScalarType>::max() : heap.top().first;
+	}
+	inline void push(ScalarType squared_distance, IndexType index)
+	{
+		if (static_cast<IndexType>(heap.size()) < capacity)
+			heap.push(Candidate(squared_distance,index));
+		else if (squared_distance < heap.top().first)
+		{
+			heap.pop();
+			heap.push(Candidate(squared_distance,index));
+		}
+	}
+	//! Returns candidates sorted by distance, empties the storage
+	std::vector<Candidate> sorted()
+	{
+		std::vector<Candidate> sorted_candidates;
+		sorted_candidates.reserve(heap.size());
+		while (!heap.empty())
+		{
+			sorted_candidates.push_back(heap.top());
+			heap.pop();
+		}
+		std::reverse(sorted_candidates.begin(),sorted_candidates.end());
+		return sorted_candidates;
+	}
+	//! Returns indices of candidates except the provided one
+	//! sorted by distance, at most capacity-1 indices are returned
+	LocalNeighbors neighbors_except(IndexType self)
+	{
+		std::vector<Candidate> sorted_candidates = sorted();
+
+		LocalNeighbors local_neighbors;
+		local_neighbors.reserve(capacity-1);
+		for (std::vector<Candidate>::const_iterator it=sorted_candidates.begin(); it!=sorted_candidates.end(); ++it)
+		{
+			if (it->second != self && static_cast<IndexType>(local_neighbors.size()) < capacity-1)
+				local_neighbors.push_back(it->second);
+		}
+		return local_neighbors;
+	}
+private:
+	std::priority_queue<Candidate> heap;
+	IndexType capacity;
+};
+
+//! KD-tree over feature vectors with Euclidean distance.
+//!
+//! Points are copied into one contiguous matrix ordered the way
+//! they are stored in the tree so each leaf holds a contiguous bucket
+//! of points. Distances to points of leaves are abandoned once they
+//! exceed the current k-th nearest one and subtrees are pruned using
+//! their bounding boxes. Recommended for low-dimensional data.
+//!
+class KDimensionalTree
+{
+public:
+	//! Constructs the tree
+	//!
+	//! @param points matrix with feature vectors in columns
+	//! @param leaf_size maximal number of points in a leaf
+	//!
+	KDimensionalTree(const DenseMatrix& points, IndexType leaf_size=16) :
+		data(), indices(points.cols()), nodes(), lower(), upper(), bucket(leaf_size)
+	{
+		for (IndexType i=0; i<points.cols(); ++i)
+			indices[i] = i;
+		nodes.reserve(2*(points.cols()/bucket+1));
+		lower.resize(points.rows(),2*(points.cols()/bucket+1));
+		upper.resize(points.rows(),2*(points.cols()/bucket+1));
+		if (points.cols() > 0)
+			build(points,0,points.cols());
+
+		data.resize(points.rows(),points.cols());
+		for (IndexType i=0; i<points.cols(); ++i)
+			data.col(i) = points.col(indices[i]);
+	}
+
+	//! Finds k nearest neighbors of the provided vector
+	//!
+	//! @param query feature vector
+	//! @param candidates storage for nearest candidates
+	//!
+	template <class VectorType>
+	void search(const VectorType& query, NearestCandidates& candidates) const
+	{
+		if (!nodes.empty())
+			search(0,query,candidates);
+	}
+
+	//! Finds k nearest neighbors of each of stored points
+	//!
+	//! @param k number of neighbors
+	//!
+	Neighbors all_neighbors(IndexType k) const
+	{
+		const IndexType n = data.cols();
+		Neighbors neighbors(n);
+#pragma omp parallel for schedule(dynamic,256)
+		for (IndexType i=0; i<n; ++i)
+		{
+			NearestCandidates candidates(k+1);
+			search(0,data.col(i),candidates);
+			neighbors[indices[i]] = candidates.neighbors_except(indices[i]);
+		}
+		return neighbors;
+	}
+
+private:
+
+	struct Node
+	{
+		Node(IndexType b, IndexType e) :
+			begin(b), end(e), dimension(-1), left(-1), right(-1)
+		{
+		}
+		//! range of points in the node
+		IndexType begin, end;
+		//! split dimension, -1 for leaves
+		IndexType dimension;
+		//! children
+		IndexType left, right;
+	};
+
+	struct CoordinateComparator
+	{
+		CoordinateComparator(const DenseMatrix& p, IndexType d) : points(p), dimension(d) {}
+		inline bool operator()(IndexType a, IndexType b) const
+		{
+			return points(dimension,a) < points(dimension,b);
+		}
+		const DenseMatrix& points;
+		IndexType dimension;
+	};
+
+	IndexType build(const DenseMatrix& points, IndexType begin, IndexType end)
+	{
+		IndexType id = nodes.size();
+		nodes.push_back(Node(begin,end));
+		if (id >= lower.cols())
+		{
+			lower.conservativeResize(Eigen::NoChange,2*id);
+			upper.conservativeResize(Eigen::NoChange,2*id);
+		}
+
+		lower.col(id) = points.col(indices[begin]);
+		upper.col(id) = points.col(indices[begin]);
+		for (IndexType i=begin+1; i<end; ++i)
+		{
+			lower.col(id) = lower.col(id).cwiseMin(points.col(indices[i]));
+			upper.col(id) = upper.col(id).cwiseMax(points.col(indices[i]));
+		}
+
+		if (end - begin <= bucket)
+			return id;
+
+		// split by median along the dimension of the largest spread
+		IndexType dimension;
+		ScalarType spread = (upper.col(id) - lower.col(id)).maxCoeff(&dimension);
+		if (spread == 0.0)
+			return id;
+
+		IndexType median = (begin + end)/2;
+		std::nth_element(indices.begin()+begin,indices.begin()+median,indices.begin()+end,
+		                 CoordinateComparator(points,dimension));
+		nodes[id].dimension = dimension;
+		IndexType left = build(points,begin,median);
+		IndexType right = build(points,median,end);
+		nodes[id].left = left;
+		nodes[id].right = right;
+		return id;
+	}
+
+	template <class VectorType>
+	inline ScalarType box_distance(IndexType id, const VectorType& query) const
+	{
+		return ((lower.col(id) - query).cwiseMax(query - upper.col(id))).cwiseMax(0.0).squaredNorm();
+	}
+
+	template <class VectorType>
+	void search(IndexType id, const VectorType& query, NearestCandidates& candidates) const
+	{
+		const Node& node = nodes[id];
+		if (node.dimension == -1)
+		{
+			for (IndexType i=node.begin; i<node.end; ++i)
+				candidates.push(bounded_squared_euclidean_distance(data.col(i),query,candidates.bound()),indices[i]);
+			return;
+		}
+
+		IndexType near = node.left;
+		IndexType far = node.right;
+		ScalarType near_distance = box_distance(near,query);
+		ScalarType far_distance = box_distance(far,query);
+		if (far_distance < near_distance)
+		{
+			std::swap(near,far);
+			std::swap(near_distance,far_distance);
+		}
+		if (near_distance < candidates.bound())
+			search(near,query,candidates);
+		if (far_distance < candidates.bound())
+			search(far,query,candidates);
+	}
+
+	//! points in the tree order
+	DenseMatrix data;
+	//! original indices of points in the tree order
+	std::vector<IndexType> indices;
+	std::vector<Node> nodes;
+	//! bounding boxes of nodes
+	DenseMatrix lower;
+	DenseMatrix upper;
+	IndexType bucket;
+};
+
+} // End of namespace tapkee_internal
+} // End of namespace tapkee
+
+#endif
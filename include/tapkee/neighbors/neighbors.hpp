@@ -13,6 +13,9 @@
 #endif
 #include <tapkee/neighbors/connected.hpp>
 #include <tapkee/neighbors/vptree.hpp>
+#include <tapkee/neighbors/kdtree.hpp>
+#include <tapkee/neighbors/balltree.hpp>
+#include <tapkee/utils/features.hpp>
 /* End of Tapkee includes */
 
 #include <vector>
@@ -49,6 +52,10 @@ struct KernelDistance
 	{
 		return sqrt(callback.kernel(*l,*l) - 2*callback.kernel(*l,*r) + callback.kernel(*r,*r));
 	}
+	inline ScalarType distance_bounded(const RandomAccessIterator& l, const RandomAccessIterator& r, ScalarType)
+	{
+		return distance(l,r);
+	}
 	typedef KernelType type;
 	Callback callback;
 };
@@ -57,6 +64,26 @@ struct DistanceType
 {
 };
 
+template <bool>
+struct bounded_distance_impl
+{
+	template <class Callback, class T>
+	static inline ScalarType distance(Callback& callback, const T& l, const T& r, ScalarType)
+	{
+		return callback.distance(l,r);
+	}
+};
+
+template <>
+struct bounded_distance_impl<true>
+{
+	template <class Callback, class T>
+	static inline ScalarType distance(Callback& callback, const T& l, const T& r, ScalarType bound)
+	{
+		return callback.distance_bounded(l,r,bound);
+	}
+};
+
 template <class RandomAccessIterator, class Callback>
 struct PlainDistance
 {
@@ -69,6 +96,12 @@ struct PlainDistance
 	{
 		return callback.distance(*l,*r);
 	}
+	//! Returns distance or any value larger than the bound if the distance exceeds it,
+	//! the computation is abandoned early if the callback provides distance_bounded
+	inline ScalarType distance_bounded(const RandomAccessIterator& l, const RandomAccessIterator& r, ScalarType bound)
+	{
+		return bounded_distance_impl<has_bounded_distance<Callback>::value>::distance(callback,*l,*r,bound);
+	}
 	typedef DistanceType type;
 	Callback callback;
 };
@@ -82,10 +115,12 @@ Neighbors find_neighbors_covertree_impl(RandomAccessIterator begin, RandomAccess
 
 	typedef CoverTreePoint<RandomAccessIterator> TreePoint;
 	v_array<TreePoint> points;
+	alloc(points, end-begin);
 	for (RandomAccessIterator iter=begin; iter!=end; ++iter)
 		push(points, TreePoint(iter, callback(iter,iter)));
 
-	node<TreePoint> ct = batch_create(callback, points);
+	cover_tree<TreePoint> ct;
+	batch_create(callback, points, ct);
 
 	v_array< v_array<TreePoint> > res;
 	++k; // because one of the neighbors will be the actual query point
@@ -110,7 +145,6 @@ Neighbors find_neighbors_covertree_impl(RandomAccessIterator begin, RandomAccess
 		free(res[i].elements);
 	};
 	free(res.elements);
-	free_children(ct);
 	free(points.elements);
 	return neighbors;
 }
@@ -162,26 +196,65 @@ Neighbors find_neighbors_vptree_impl(const RandomAccessIterator& begin, const Ra
 	for (RandomAccessIterator i=begin; i!=end; ++i)
 	{
 		LocalNeighbors local_neighbors = tree.search(i,k+1);
-		std::remove(local_neighbors.begin(),local_neighbors.end(),i-begin);
+		local_neighbors.erase(std::remove(local_neighbors.begin(),local_neighbors.end(),i-begin),
+		                      local_neighbors.end());
+		// neighbors are sorted from the farthest one, drop it if
+		// the query point wasn't found due to duplicates
+		if (static_cast<IndexType>(local_neighbors.size()) > k)
+			local_neighbors.erase(local_neighbors.begin());
 		neighbors.push_back(local_neighbors);
 	}
 
 	return neighbors;
 }
 
-template <class RandomAccessIterator, class Callback>
-Neighbors find_neighbors(NeighborsMethod method, const RandomAccessIterator& begin, 
-                         const RandomAccessIterator& end, const Callback& callback, 
-                         IndexType k, bool check_connectivity)
+template <class Tree, class RandomAccessIterator, class FeaturesCallback>
+Neighbors find_neighbors_features_tree_impl(const RandomAccessIterator& begin, const RandomAccessIterator& end, 
+                                            FeaturesCallback features, IndexType dimension, IndexType k)
 {
-	if (k > static_cast<IndexType>(end-begin-1))
+	DenseMatrix points = dense_matrix_from_features(features,dimension,begin,end);
+	Tree tree(points);
+	return tree.all_neighbors(k);
+}
+
+template <class RandomAccessIterator, class FeaturesCallback>
+Neighbors find_neighbors_kdtree_impl(const RandomAccessIterator& begin, const RandomAccessIterator& end, 
+                                     FeaturesCallback features, IndexType dimension, IndexType k)
+{
+	timed_context context("KD-tree based neighbors search");
+	return find_neighbors_features_tree_impl<KDimensionalTree>(begin,end,features,dimension,k);
+}
+
+template <class RandomAccessIterator, class FeaturesCallback>
+Neighbors find_neighbors_balltree_impl(const RandomAccessIterator& begin, const RandomAccessIterator& end, 
+                                       FeaturesCallback features, IndexType dimension, IndexType k)
+{
+	timed_context context("Ball tree based neighbors search");
+	return find_neighbors_features_tree_impl<MetricBallTree>(begin,end,features,dimension,k);
+}
+
+inline IndexType checked_number_of_neighbors(IndexType k, IndexType n)
+{
+	if (k > n-1)
 	{
 		LoggingSingleton::instance().message_warning("Number of neighbors is greater than number of objects to embed. "
 		                                             "Using greatest possible number of neighbors.");
-		k = static_cast<IndexType>(end-begin-1);
+		k = n-1;
 	}
+	return k;
+}
+
+template <class RandomAccessIterator, class Callback>
+Neighbors find_neighbors(NeighborsMethod method, const RandomAccessIterator& begin, 
+                         const RandomAccessIterator& end, const Callback& callback, 
+                         IndexType k, bool check_connectivity)
+{
+	k = checked_number_of_neighbors(k,static_cast<IndexType>(end-begin));
 	LoggingSingleton::instance().message_info("Using the " + get_neighbors_method_name(method) + " neighbors computation method.");
 
+	if (method.is(KdTree) || method.is(BallTree))
+		throw unsupported_method_error("KD-tree and ball tree neighbors methods require features callback");
+
 	Neighbors neighbors;
 	if (method.is(Brute))
 		neighbors = find_neighbors_bruteforce_impl(begin,end,callback,k);
@@ -200,6 +273,106 @@ Neighbors find_neighbors(NeighborsMethod method, const RandomAccessIterator& beg
 	return neighbors;
 }
 
+//! Finds neighbors using the provided method. KD-tree and ball tree methods
+//! use Euclidean distance between feature vectors provided by the features
+//! callback, other methods use the distance callback.
+//!
+//! @param method neighbors computation method
+//! @param begin begin of the range of objects
+//! @param end end of the range of objects
+//! @param callback distance callback
+//! @param features features callback
+//! @param dimension dimension of feature vectors
+//! @param k number of neighbors
+//! @param check_connectivity whether connectivity of the graph should be checked
+//!
+template <class RandomAccessIterator, class Callback, class FeaturesCallback>
+Neighbors find_neighbors(NeighborsMethod method, const RandomAccessIterator& begin, 
+                         const RandomAccessIterator& end, const Callback& callback, 
+                         const FeaturesCallback& features, IndexType dimension,
+                         IndexType k, bool check_connectivity)
+{
+	if (!method.is(KdTree) && !method.is(BallTree))
+		return find_neighbors(method,begin,end,callback,k,check_connectivity);
+
+	k = checked_number_of_neighbors(k,static_cast<IndexType>(end-begin));
+	LoggingSingleton::instance().message_info("Using the " + get_neighbors_method_name(method) + " neighbors computation method.");
+
+	Neighbors neighbors;
+	if (method.is(KdTree))
+		neighbors = find_neighbors_kdtree_impl(begin,end,features,dimension,k);
+	if (method.is(BallTree))
+		neighbors = find_neighbors_balltree_impl(begin,end,features,dimension,k);
+
+	if (check_connectivity)
+	{
+		if (!is_connected(begin,end,neighbors))
+			LoggingSingleton::instance().message_warning("The neighborhood graph is not connected.");
+	}
+	return neighbors;
+}
+
+//! Returns first k neighbors of each of vectors from precomputed 
+//! neighbors sorted by increasing distance.
+//!
+//! @param precomputed precomputed neighbors
+//! @param k number of neighbors
+//! @param n_vectors number of vectors
+//!
+inline Neighbors truncated_neighbors(const Neighbors& precomputed, IndexType k, IndexType n_vectors)
+{
+	if (static_cast<IndexType>(precomputed.size()) != n_vectors)
+	{
+		throw wrong_parameter_error(formatting::format("Precomputed neighbors are given for {} vectors "
+			"while there are {} vectors to embed.", precomputed.size(), n_vectors));
+	}
+	k = checked_number_of_neighbors(k,n_vectors);
+	LoggingSingleton::instance().message_info("Using precomputed neighbors.");
+
+	Neighbors neighbors(n_vectors);
+	for (IndexType i=0; i<n_vectors; ++i)
+	{
+		if (static_cast<IndexType>(precomputed[i].size()) < k)
+		{
+			throw wrong_parameter_error(formatting::format("There are only {} precomputed neighbors "
+				"of vector {} while {} neighbors are required.", precomputed[i].size(), i, k));
+		}
+		neighbors[i].assign(precomputed[i].begin(),precomputed[i].begin()+k);
+	}
+	return neighbors;
+}
+
+//! Sorts neighbors of each of vectors by increasing distance so
+//! neighbors found with any of methods could be truncated to any
+//! smaller number of neighbors (see @ref tapkee::keywords::precomputed_neighbors).
+//!
+//! @param begin begin of the range of objects
+//! @param callback distance callback
+//! @param neighbors neighbors to sort
+//!
+template <class RandomAccessIterator, class Callback>
+void sort_neighbors(const RandomAccessIterator& begin, Callback callback, Neighbors& neighbors)
+{
+	timed_context context("Neighbors sorting");
+
+	const IndexType n_vectors = neighbors.size();
+#pragma omp parallel
+	{
+		std::vector< std::pair<ScalarType,IndexType> > distances;
+#pragma omp for schedule(dynamic,256)
+		for (IndexType i=0; i<n_vectors; ++i)
+		{
+			LocalNeighbors& local_neighbors = neighbors[i];
+			distances.resize(local_neighbors.size());
+			for (size_t j=0; j<local_neighbors.size(); ++j)
+				distances[j] = std::make_pair(callback.distance(begin[i],begin[local_neighbors[j]]),local_neighbors[j]);
+			std::sort(distances.begin(),distances.end());
+			for (size_t j=0; j<local_neighbors.size(); ++j)
+				local_neighbors[j] = distances[j].second;
+		}
+	}
+}
+
 } // End of namespace tapkee
 } // End of namespace tapkee_internal
 
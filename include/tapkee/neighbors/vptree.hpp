@@ -182,7 +182,9 @@ private:
 		if (node == NULL) 
 			return;
 
-		double distance = callback.distance(items[node->index], target);
+		// pruning decisions are the same for any distance larger than 
+		// tau + threshold so its computation can be abandoned there
+		double distance = callback.distance_bounded(items[node->index], target, tau + node->threshold);
 
 		if (distance < tau) 
 		{
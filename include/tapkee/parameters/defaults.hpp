@@ -19,6 +19,7 @@ const stichwort::ParametersSet defaults = (
 	tapkee::num_neighbors = stichwort::by_default,
 	tapkee::target_dimension = stichwort::by_default,
 	tapkee::diffusion_map_timesteps = stichwort::by_default,
+	tapkee::diffusion_map_nystrom = stichwort::by_default,
 	tapkee::gaussian_kernel_width = stichwort::by_default,
 	tapkee::max_iteration = stichwort::by_default,
 	tapkee::spe_global_strategy = stichwort::by_default,
@@ -33,6 +34,10 @@ const stichwort::ParametersSet defaults = (
 	tapkee::cancel_function = stichwort::by_default,
 	tapkee::sne_perplexity = stichwort::by_default,
 	tapkee::squishing_rate = stichwort::by_default,
+	tapkee::collapse_duplicates = stichwort::by_default,
+	tapkee::sample_size = stichwort::by_default,
+	tapkee::sampling_method = stichwort::by_default,
+	tapkee::precomputed_neighbors = stichwort::by_default,
 	tapkee::sne_theta = stichwort::by_default);
 }
 
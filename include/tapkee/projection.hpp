@@ -6,6 +6,10 @@
 #ifndef TAPKEE_PROJECTION_H_
 #define TAPKEE_PROJECTION_H_
 
+#if TAPKEE_HAS_ATOMICS
+	#include <atomic>
+#endif
+
 namespace tapkee
 {
 
@@ -21,24 +25,125 @@ struct ProjectionImplementation
 	virtual DenseVector project(const DenseVector& vec) = 0;
 };
 
-//! A pimpl wrapper for projecting function
+namespace tapkee_internal
+{
+
+//! A thread-safe counter of references to a shared object
+class ReferenceCounter
+{
+public:
+	ReferenceCounter() : count(1)
+	{
+	}
+	//! Increments the counter
+	inline void acquire()
+	{
+#if TAPKEE_HAS_ATOMICS
+		count.fetch_add(1);
+#elif defined(__GNUC__)
+		__sync_add_and_fetch(&count,1);
+#else
+		++count;
+#endif
+	}
+	//! Decrements the counter
+	//! @return true if it was the last reference
+	inline bool release()
+	{
+#if TAPKEE_HAS_ATOMICS
+		return count.fetch_sub(1) == 1;
+#elif defined(__GNUC__)
+		return __sync_sub_and_fetch(&count,1) == 0;
+#else
+		return --count == 0;
+#endif
+	}
+private:
+	ReferenceCounter(const ReferenceCounter&);
+	ReferenceCounter& operator=(const ReferenceCounter&);
+#if TAPKEE_HAS_ATOMICS
+	std::atomic<int> count;
+#else
+	int count;
+#endif
+};
+
+}
+
+//! A pimpl wrapper for projecting function. 
+//!
+//! The implementation is shared between copies of the function
+//! and is destroyed with the last of them, so a projecting function
+//! can be copied to any number of threads without copying the 
+//! implementation. Implementations are expected not to change 
+//! their state while projecting.
 struct ProjectingFunction
 {
-	ProjectingFunction() : implementation(NULL) {};
-	ProjectingFunction(ProjectionImplementation* impl) : implementation(impl) {};
-	//! Destroys current implementation
+	ProjectingFunction() : implementation(NULL), counter(NULL) {};
+	//! Takes ownership of the provided implementation
+	ProjectingFunction(ProjectionImplementation* impl) : 
+		implementation(impl), counter(impl ? new tapkee_internal::ReferenceCounter : NULL) {};
+	ProjectingFunction(const ProjectingFunction& that) :
+		implementation(that.implementation), counter(that.counter)
+	{
+		if (counter)
+			counter->acquire();
+	}
+	ProjectingFunction& operator=(const ProjectingFunction& that)
+	{
+		if (that.counter)
+			that.counter->acquire();
+		clear();
+		implementation = that.implementation;
+		counter = that.counter;
+		return *this;
+	}
+#ifdef TAPKEE_HAS_RVALUE_REFERENCES
+	ProjectingFunction(ProjectingFunction&& that) :
+		implementation(that.implementation), counter(that.counter)
+	{
+		that.implementation = NULL;
+		that.counter = NULL;
+	}
+	ProjectingFunction& operator=(ProjectingFunction&& that)
+	{
+		if (this != &that)
+		{
+			clear();
+			implementation = that.implementation;
+			counter = that.counter;
+			that.implementation = NULL;
+			that.counter = NULL;
+		}
+		return *this;
+	}
+#endif
+	~ProjectingFunction()
+	{
+		clear();
+	}
+	//! Releases current implementation, it is destroyed
+	//! if there are no other copies of this function
 	void clear() 
 	{ 
-		delete implementation;
+		if (counter && counter->release())
+		{
+			delete implementation;
+			delete counter;
+		}
+		implementation = NULL;
+		counter = NULL;
 	}
 	//! Projects provided vector to new space
 	//! @param vec vector to be projected
 	//! @return projected vector
-	inline DenseVector operator()(const DenseVector& vec)
+	inline DenseVector operator()(const DenseVector& vec) const
 	{
 		return implementation->project(vec);
 	}
 	ProjectionImplementation* implementation;
+private:
+	tapkee_internal::ReferenceCounter* counter;
 };
 
 //! Basic @ref ProjectionImplementation that subtracts mean from the vector
@@ -55,7 +160,7 @@ struct MatrixProjectionImplementation : public ProjectionImplementation
 
 	virtual DenseVector project(const DenseVector& vec) 
 	{
-		return proj_mat*(vec-mean_vec);
+		return proj_mat.transpose()*(vec-mean_vec);
 	}
 
 	DenseMatrix proj_mat;
@@ -9,6 +9,7 @@
 /* Tapkee includes */
 #include <tapkee/defines.hpp>
 #include <tapkee/utils/time.hpp>
+#include <tapkee/routines/eigendecomposition.hpp>
 /* End of Tapkee includes */
 
 namespace tapkee
@@ -80,6 +81,104 @@ DenseSymmetricMatrix compute_diffusion_matrix(RandomAccessIterator begin, Random
 	return diffusion_matrix;
 }
 
+//! Computes Nystrom approximation of the diffusion process matrix 
+//! (see @ref compute_diffusion_matrix) restricted to columns of landmarks.
+//! Only the \f$ N \times m \f$ block \f$ C \f$ of the kernel matrix is formed.
+//! Column sums of the full matrix are approximated by sums over landmarks
+//! scaled by \f$ N/m \f$ for both normalizations.
+//!
+//! @param begin begin data iterator
+//! @param end end data iterator
+//! @param landmarks indices of landmarks
+//! @param callback distance callback
+//! @param timesteps number of timesteps \f$ t \f$ of diffusion process
+//! @param width width \f$ w \f$ of the gaussian kernel
+//!
+template <class RandomAccessIterator, class DistanceCallback>
+DenseMatrix compute_diffusion_matrix_nystrom(RandomAccessIterator begin, RandomAccessIterator end, 
+                                             const Landmarks& landmarks, DistanceCallback callback,
+                                             const IndexType timesteps, const ScalarType width)
+{
+	timed_context context("Nystrom diffusion map matrix computation");
+
+	const IndexType n_vectors = end-begin;
+	const IndexType n_landmarks = landmarks.size();
+	const ScalarType scale = static_cast<ScalarType>(n_vectors)/n_landmarks;
+	DenseMatrix diffusion_matrix(n_vectors,n_landmarks);
+
+	RESTRICT_ALLOC;
+
+	// compute gaussian kernel block
+#pragma omp parallel for
+	for (IndexType i=0; i<n_vectors; ++i)
+	{
+		for (IndexType j=0; j<n_landmarks; ++j)
+		{
+			ScalarType k = callback.distance(begin[i],begin[landmarks[j]]);
+			diffusion_matrix(i,j) = exp(-(k*k)/width);
+		}
+	}
+
+	DenseVector p = scale*diffusion_matrix.rowwise().sum();
+	DenseVector landmarks_p(n_landmarks);
+	for (IndexType j=0; j<n_landmarks; ++j)
+		landmarks_p(j) = p(landmarks[j]);
+
+	for (IndexType j=0; j<n_landmarks; ++j)
+		for (IndexType i=0; i<n_vectors; ++i)
+			diffusion_matrix(i,j) /= pow(p(i)*landmarks_p(j),timesteps);
+
+	p = (scale*diffusion_matrix.rowwise().sum()).cwiseSqrt();
+	for (IndexType j=0; j<n_landmarks; ++j)
+		landmarks_p(j) = p(landmarks[j]);
+
+	for (IndexType j=0; j<n_landmarks; ++j)
+		for (IndexType i=0; i<n_vectors; ++i)
+			diffusion_matrix(i,j) /= p(i)*landmarks_p(j);
+
+	UNRESTRICT_ALLOC;
+
+	return diffusion_matrix;
+}
+
+//! Computes the embedding from the Nystrom approximated diffusion process
+//! matrix \f$ C \f$. Eigenvectors \f$ u \f$ of the \f$ m \times m \f$ block 
+//! \f$ W \f$ of landmarks rows are extended to all vectors with \f$ C u \f$ 
+//! normalized to unit norm (just like eigenvectors of the full matrix).
+//!
+//! @param diffusion_matrix Nystrom approximated matrix \f$ C \f$
+//! @param landmarks indices of landmarks
+//! @param eigen_method eigendecomposition method
+//! @param strategy computation strategy
+//! @param target_dimension target dimension
+//!
+inline DenseMatrix nystrom_diffusion_embedding(const DenseMatrix& diffusion_matrix, const Landmarks& landmarks,
+                                               const EigenMethod& eigen_method, const ComputationStrategy& strategy,
+                                               IndexType target_dimension)
+{
+	timed_context context("Nystrom extension");
+
+	const IndexType n_landmarks = landmarks.size();
+	DenseSymmetricMatrix landmarks_matrix(n_landmarks,n_landmarks);
+	for (IndexType i=0; i<n_landmarks; ++i)
+		landmarks_matrix.row(i) = diffusion_matrix.row(landmarks[i]);
+	// symmetrize to cancel rounding errors
+	landmarks_matrix = 0.5*(landmarks_matrix + landmarks_matrix.transpose());
+
+	DenseMatrix landmarks_embedding = 
+		eigendecomposition(eigen_method,strategy,SquaredLargestEigenvalues,
+				landmarks_matrix,target_dimension).first;
+
+	DenseMatrix embedding = diffusion_matrix*landmarks_embedding;
+	for (IndexType i=0; i<target_dimension; ++i)
+	{
+		ScalarType norm = embedding.col(i).norm();
+		if (norm > 0.0)
+			embedding.col(i) /= norm;
+	}
+	return embedding;
+}
+
 } // End of namespace tapkee_internal
 } // End of namespace tapkee
 
@@ -0,0 +1,148 @@
+/* This software is distributed under BSD 3-clause license (see LICENSE file).
+ *
+ * Copyright (c) 2012-2013 Sergey Lisitsyn
+ */
+
+#ifndef TAPKEE_DUPLICATES_H_
+#define TAPKEE_DUPLICATES_H_
+
+/* Tapkee includes */
+#include <tapkee/defines.hpp>
+#include <tapkee/utils/time.hpp>
+/* End of Tapkee includes */
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cstring>
+
+namespace tapkee
+{
+namespace tapkee_internal
+{
+
+//! Result of grouping exactly equal feature vectors
+struct UniqueVectors
+{
+	//! indices of representatives (first occurrences of
+	//! distinct vectors) in the increasing order
+	std::vector<IndexType> representatives;
+	//! index of the representative (in the representatives
+	//! vector) of each of vectors
+	std::vector<IndexType> mapping;
+	//! number of vectors collapsed into each of representatives
+	std::vector<IndexType> multiplicities;
+};
+
+//! Returns FNV-1a hash of coordinates of the vector
+inline size_t hash_vector(const DenseVector& vector)
+{
+	size_t hash = 2166136261u;
+	for (IndexType i=0; i<vector.size(); ++i)
+	{
+		// adding zero turns negative zero into the positive one
+		ScalarType value = vector(i) + ScalarType(0.0);
+		unsigned char bytes[sizeof(ScalarType)];
+		std::memcpy(bytes,&value,sizeof(ScalarType));
+		for (size_t j=0; j<sizeof(ScalarType); ++j)
+		{
+			hash ^= bytes[j];
+			hash *= 16777619u;
+		}
+	}
+	return hash;
+}
+
+//! Groups exactly equal feature vectors. Vectors are hashed in
+//! parallel, sorted by their hashes and compared coordinate-wise
+//! only within groups of equal hashes.
+//!
+//! @param begin begin iterator of data
+//! @param end end iterator of data
+//! @param features features callback
+//! @param dimension dimension of feature vectors
+//!
+template <class RandomAccessIterator, class FeaturesCallback>
+UniqueVectors find_unique_vectors(RandomAccessIterator begin, RandomAccessIterator end,
+                                  FeaturesCallback features, IndexType dimension)
+{
+	timed_context context("Duplicate vectors search");
+
+	typedef std::pair<size_t,IndexType> HashedIndex;
+	const IndexType n = end-begin;
+	DenseMatrix vectors(dimension,n);
+	std::vector<HashedIndex> hashes(n);
+
+#pragma omp parallel
+	{
+		DenseVector vector(dimension);
+#pragma omp for
+		for (IndexType i=0; i<n; ++i)
+		{
+			features.vector(*(begin+i),vector);
+			vectors.col(i) = vector;
+			hashes[i] = HashedIndex(hash_vector(vector),i);
+		}
+	}
+
+	// equal vectors have equal hashes and within a group of equal
+	// hashes indices are increasing so the first occurrence comes first
+	std::sort(hashes.begin(),hashes.end());
+	std::vector<IndexType> first(n);
+	for (IndexType group_begin=0, group_end=0; group_begin<n; group_begin=group_end)
+	{
+		while (group_end<n && hashes[group_end].first==hashes[group_begin].first)
+			++group_end;
+		for (IndexType j=group_begin; j<group_end; ++j)
+		{
+			IndexType index = hashes[j].second;
+			first[index] = index;
+			for (IndexType l=group_begin; l<j; ++l)
+			{
+				IndexType candidate = hashes[l].second;
+				if (first[candidate]==candidate && vectors.col(candidate)==vectors.col(index))
+				{
+					first[index] = candidate;
+					break;
+				}
+			}
+		}
+	}
+
+	UniqueVectors unique;
+	unique.mapping.resize(n);
+	for (IndexType i=0; i<n; ++i)
+	{
+		if (first[i]==i)
+		{
+			unique.mapping[i] = unique.representatives.size();
+			unique.representatives.push_back(i);
+			unique.multiplicities.push_back(0);
+		}
+		else
+			unique.mapping[i] = unique.mapping[first[i]];
+		unique.multiplicities[unique.mapping[i]]++;
+	}
+	return unique;
+}
+
+//! Returns embedding of all vectors given the embedding of
+//! representatives, rows of duplicates are copies of the
+//! representative's row.
+//!
+//! @param embedding embedding of representatives
+//! @param unique grouping of vectors
+//!
+inline DenseMatrix expand_embedding(const DenseMatrix& embedding, const UniqueVectors& unique)
+{
+	const IndexType n = unique.mapping.size();
+	DenseMatrix expanded(n,embedding.cols());
+	for (IndexType i=0; i<n; ++i)
+		expanded.row(i) = embedding.row(unique.mapping[i]);
+	return expanded;
+}
+
+}
+}
+
+#endif
@@ -17,6 +17,7 @@
 	#include <tapkee/utils/arpack_wrapper.hpp>
 #endif
 #include <tapkee/routines/matrix_operations.hpp>
+#include <tapkee/routines/multigrid.hpp>
 #include <tapkee/defines.hpp>
 /* End of Tapkee includes */
 
@@ -96,7 +97,8 @@ EigendecompositionResult eigendecomposition_impl_randomized(const MatrixType& wm
 	}
 	MatrixOperationType operation(wm);
 
-	DenseMatrix Y = operation(O);
+	DenseMatrix Y(wm.rows(), target_dimension+skip);
+	operation.apply(O,Y);
 	for (IndexType i=0; i<Y.cols(); i++)
 	{
 		for (IndexType j=0; j<i; j++)
@@ -113,8 +115,9 @@ EigendecompositionResult eigendecomposition_impl_randomized(const MatrixType& wm
 		Y.col(i) *= (1.f / norm);
 	}
 
-	DenseMatrix B1 = operation(Y);
-	DenseMatrix B = Y.householderQr().solve(B1);
+	// random matrix storage is reused for the second product
+	operation.apply(Y,O);
+	DenseMatrix B = Y.householderQr().solve(O);
 	DenseSelfAdjointEigenSolver eigenOfB(B);
 
 	if (eigenOfB.info() == Eigen::Success)
@@ -138,6 +141,517 @@ EigendecompositionResult eigendecomposition_impl_randomized(const MatrixType& wm
 	return EigendecompositionResult();
 }
 
+//! Returns shift used to compute smallest non-trivial eigenvalues 
+//! of the provided positive semi-definite matrix. The shift is negative
+//! so the shifted matrix is positive definite even if rounding errors
+//! make the matrix slightly indefinite, and it is small compared to the 
+//! scale of the matrix so the smallest eigenvalues remain well separated 
+//! in the shift-inverted spectrum. Errors of solves along the nullspace
+//! are removed by the deflation.
+//!
+//! @param matrix matrix to be eigendecomposed
+//!
+inline ScalarType deflation_shift(const SparseWeightMatrix& matrix)
+{
+	DenseVector diagonal = matrix.diagonal();
+	ScalarType scale = diagonal.size() ? diagonal.cwiseAbs().maxCoeff() : 0.0;
+	return -1e-10*std::max(scale,ScalarType(1e-12));
+}
+
+//! Checks whether the constant vector is (numerically) in the nullspace
+//! of the provided matrix, as it is for alignment matrices and 
+//! Laplacians constructed by the methods.
+//!
+//! @param matrix matrix to be checked
+//!
+inline bool has_constant_nullspace(const SparseWeightMatrix& matrix)
+{
+	const IndexType n = matrix.rows();
+	if (n < 2)
+		return false;
+	DenseVector diagonal = matrix.diagonal();
+	ScalarType scale = diagonal.cwiseAbs().maxCoeff();
+	DenseVector image = matrix*DenseVector::Ones(n);
+	return image.norm() <= 1e-6*scale*sqrt(ScalarType(n));
+}
+
+//! Maps eigenpairs of the shift-inverted operation back to eigenpairs 
+//! of the original matrix. Eigenvalues of the operation are expected 
+//! to be sorted in ascending order, the resulting eigenvalues are sorted 
+//! in ascending order as well.
+//!
+//! @param inverted eigenpairs of the shift-inverted operation
+//! @param sigma shift of the operation
+//!
+inline EigendecompositionResult shift_inverted_eigenpairs(const EigendecompositionResult& inverted, ScalarType sigma)
+{
+	const IndexType k = inverted.second.size();
+	DenseMatrix eigenvectors(inverted.first.rows(),k);
+	DenseVector eigenvalues(k);
+	for (IndexType i=0; i<k; ++i)
+	{
+		eigenvectors.col(i) = inverted.first.col(k-1-i);
+		eigenvalues(i) = sigma + 1.0/inverted.second(k-1-i);
+	}
+	return EigendecompositionResult(eigenvectors,eigenvalues);
+}
+
+//! Computes smallest non-trivial eigenvalues and associated eigenvectors
+//! of the matrix with known nullspace. Instead of computing an extra
+//! eigenvector and skipping it the nullspace is deflated explicitly 
+//! and the largest eigenvalues of the shift-inverted operation are 
+//! computed with the provided method.
+//!
+//! @param method one of ARPACK or Randomized methods
+//! @param deflated matrix with its nullspace and shift
+//! @param target_dimension number of eigenvectors to be computed
+//!
+inline EigendecompositionResult eigendecomposition_impl_deflated(const EigenMethod& method, 
+                                                                 const DeflatedSparseMatrix& deflated, 
+                                                                 IndexType target_dimension)
+{
+#ifdef TAPKEE_WITH_ARPACK
+	if (method.is(Arpack))
+	{
+		timed_context context("ARPACK deflated shift-invert eigendecomposition");
+
+		ArpackGeneralizedSelfAdjointEigenSolver<DeflatedSparseMatrix, SparseWeightMatrix, SparseDeflatedShiftInvertMatrixOperation>
+			arpack(deflated,target_dimension,SparseDeflatedShiftInvertMatrixOperation::ARPACK_CODE);
+
+		if (arpack.info() == Eigen::Success)
+		{
+			std::string message = formatting::format("Took {} iterations.", arpack.getNbrIterations());
+			LoggingSingleton::instance().message_info(message);
+			return shift_inverted_eigenpairs(EigendecompositionResult(arpack.eigenvectors(),arpack.eigenvalues()),
+			                                 deflated.sigma);
+		}
+		else
+		{
+			throw eigendecomposition_error("eigendecomposition failed");
+		}
+	}
+#endif
+	if (method.is(Randomized))
+	{
+		return shift_inverted_eigenpairs(
+			eigendecomposition_impl_randomized<DeflatedSparseMatrix,SparseDeflatedShiftInvertMatrixOperation>
+				(deflated,target_dimension,0), deflated.sigma);
+	}
+	throw unsupported_method_error("Unsupported method");
+	return EigendecompositionResult();
+}
+
+//! Orthonormalizes columns of the provided block against the orthonormal
+//! block and among themselves. Columns that are numerically dependent
+//! are dropped so the resulting block might have less columns.
+//!
+//! @param block block to be orthonormalized (replaced with the result)
+//! @param orthonormal block with orthonormal columns
+//!
+inline void lobpcg_orthonormalize(DenseMatrix& block, const DenseMatrix& orthonormal)
+{
+	// two passes of projection and gram-based normalization 
+	// restore orthogonality lost in the first one
+	for (int pass=0; pass<2 && block.cols()>0; ++pass)
+	{
+		block -= orthonormal*(orthonormal.transpose()*block);
+		DenseMatrix gram = block.transpose()*block;
+		DenseSelfAdjointEigenSolver gram_solver(gram);
+		const DenseVector& gram_values = gram_solver.eigenvalues();
+		ScalarType threshold = gram_values.maxCoeff()*1e-12;
+		IndexType rank = 0;
+		for (IndexType i=0; i<gram_values.size(); ++i)
+		{
+			if (gram_values[i] > threshold && gram_values[i] > 0.0)
+				rank++;
+		}
+		// eigenvalues are sorted in ascending order so 
+		// the kept ones are the rightmost ones
+		DenseMatrix normalization = gram_solver.eigenvectors().rightCols(rank);
+		for (IndexType i=0; i<rank; ++i)
+			normalization.col(i) /= sqrt(gram_values[gram_values.size()-rank+i]);
+		block = block*normalization;
+	}
+}
+
+//! Computes wanted eigenpairs of the operation directly by applying it
+//! to the identity matrix. Used for problems that are too small for
+//! iterative block methods.
+//!
+//! @param operation operation to be eigendecomposed
+//! @param n size of the problem
+//! @param nev number of eigenpairs to be computed
+//! @param largest whether largest or smallest eigenpairs should be computed
+//! @param eigenvectors storage for eigenvectors
+//! @param eigenvalues storage for eigenvalues sorted in ascending order
+//!
+template <class MatrixOperationType>
+void direct_eigenpairs(MatrixOperationType& operation, IndexType n, IndexType nev, bool largest,
+                       DenseMatrix& eigenvectors, DenseVector& eigenvalues)
+{
+	DenseMatrix full(n,n);
+	operation.apply(DenseMatrix::Identity(n,n),full);
+	DenseMatrix symmetric_full = 0.5*(full + full.transpose());
+	DenseSelfAdjointEigenSolver solver(symmetric_full);
+	if (solver.info() != Eigen::Success)
+		throw eigendecomposition_error("eigendecomposition failed");
+	eigenvectors = largest ? solver.eigenvectors().rightCols(nev) : solver.eigenvectors().leftCols(nev);
+	eigenvalues = largest ? solver.eigenvalues().tail(nev) : solver.eigenvalues().head(nev);
+}
+
+//! Selects target eigenpairs out of computed ones the same way
+//! other eigendecomposition implementations do.
+//!
+//! @param eigenvectors computed eigenvectors
+//! @param eigenvalues computed eigenvalues sorted in ascending order
+//! @param target_dimension number of eigenpairs to be selected
+//! @param skip number of smallest eigenpairs to skip
+//! @param largest whether largest or smallest eigenpairs were computed
+//!
+inline EigendecompositionResult select_eigenpairs(const DenseMatrix& eigenvectors, const DenseVector& eigenvalues,
+                                                  IndexType target_dimension, unsigned int skip, bool largest)
+{
+	if (largest)
+	{
+		assert(skip==0);
+		DenseMatrix selected_eigenvectors = eigenvectors.rightCols(target_dimension);
+		return EigendecompositionResult(selected_eigenvectors,eigenvalues.tail(target_dimension));
+	}
+	else
+	{
+		DenseMatrix selected_eigenvectors = eigenvectors.middleCols(skip,target_dimension);
+		return EigendecompositionResult(selected_eigenvectors,eigenvalues.segment(skip,target_dimension));
+	}
+}
+
+//! Preconditioner that leaves residuals as is
+struct IdentityPreconditioner
+{
+	template <class InputType, class OutputType>
+	inline void apply(const Eigen::MatrixBase<InputType>& rhs, const Eigen::MatrixBase<OutputType>& result) const
+	{
+		result.const_cast_derived() = rhs;
+	}
+};
+
+//! LOBPCG implementation of eigendecomposition-based embedding. 
+//! Operation is applied to blocks of vectors at each iteration 
+//! so matrix-vector products become matrix-matrix products.
+//!
+//! @param wm matrix to be eigendecomposed
+//! @param target_dimension number of eigenvectors to be computed
+//! @param skip number of smallest eigenvectors to skip
+//! @param largest whether largest or smallest eigenvalues of the operation 
+//!        should be computed
+//! @param preconditioner approximate inverse of the matrix applied to 
+//!        residuals, e.g. @ref SmoothedAggregationPreconditioner for
+//!        smallest eigenvalues of sparse matrices
+//!
+template <class MatrixType, class MatrixOperationType, class PreconditionerType> 
+EigendecompositionResult eigendecomposition_impl_lobpcg(const MatrixType& wm, IndexType target_dimension, 
+                                                        unsigned int skip, bool largest,
+                                                        const PreconditionerType& preconditioner)
+{
+	timed_context context("LOBPCG eigendecomposition");
+
+	const IndexType n = wm.rows();
+	const IndexType nev = target_dimension + skip;
+	// some extra vectors in the block improve convergence of the wanted ones
+	const IndexType block_size = std::min(n, nev + std::min(nev, IndexType(8)));
+	const IndexType max_iterations = 1000;
+	const ScalarType tolerance = 1e-9;
+
+	MatrixOperationType operation(wm);
+
+	DenseMatrix X;
+	DenseVector theta;
+
+	if (3*block_size >= n)
+	{
+		LoggingSingleton::instance().message_info("Problem is too small for LOBPCG, solving it directly.");
+		direct_eigenpairs(operation,n,nev,largest,X,theta);
+	}
+	else
+	{
+		X.resize(n,block_size);
+		for (IndexType i=0; i<n; ++i)
+		{
+			for (IndexType j=0; j<block_size; j++)
+				X(i,j) = tapkee::gaussian_random();
+		}
+		lobpcg_orthonormalize(X,DenseMatrix(n,0));
+		DenseMatrix AX(n,X.cols());
+		operation.apply(X,AX);
+
+		DenseMatrix basis;
+		DenseMatrix operated_basis;
+		DenseMatrix residuals(n,X.cols());
+		DenseMatrix directions;
+		ScalarType operator_norm = 0.0;
+		bool converged = false;
+		IndexType iteration = 0;
+
+		for (; iteration<max_iterations; ++iteration)
+		{
+			// Rayleigh-Ritz procedure on span of X and the search directions
+			IndexType basis_size = X.cols() + basis.cols();
+			DenseMatrix projected(basis_size,basis_size);
+			projected.topLeftCorner(X.cols(),X.cols()) = X.transpose()*AX;
+			if (basis.cols() > 0)
+			{
+				projected.topRightCorner(X.cols(),basis.cols()) = X.transpose()*operated_basis;
+				projected.bottomLeftCorner(basis.cols(),X.cols()) = 
+					projected.topRightCorner(X.cols(),basis.cols()).transpose();
+				projected.bottomRightCorner(basis.cols(),basis.cols()) = basis.transpose()*operated_basis;
+			}
+			projected = 0.5*(projected + projected.transpose()).eval();
+			DenseSelfAdjointEigenSolver ritz(projected);
+			if (ritz.info() != Eigen::Success)
+				throw eigendecomposition_error("eigendecomposition failed");
+
+			IndexType offset = largest ? basis_size-block_size : 0;
+			DenseMatrix coefficients = ritz.eigenvectors().middleCols(offset,block_size);
+			theta = ritz.eigenvalues().segment(offset,block_size);
+			operator_norm = std::max(operator_norm, ritz.eigenvalues().cwiseAbs().maxCoeff());
+
+			if (basis.cols() > 0)
+			{
+				directions = basis*coefficients.bottomRows(basis.cols());
+				X = X*coefficients.topRows(X.cols()) + directions;
+				AX = AX*coefficients.topRows(AX.cols()) + operated_basis*coefficients.bottomRows(basis.cols());
+			}
+			else
+			{
+				X = X*coefficients;
+				AX = AX*coefficients;
+			}
+
+			residuals.noalias() = AX - X*theta.asDiagonal();
+			ScalarType max_residual = 0.0;
+			IndexType wanted_offset = largest ? block_size-nev : 0;
+			for (IndexType j=wanted_offset; j<wanted_offset+nev; ++j)
+				max_residual = std::max(max_residual, residuals.col(j).norm());
+			if (max_residual <= tolerance*std::max(operator_norm,ScalarType(1e-12)))
+			{
+				converged = true;
+				break;
+			}
+
+			// new search directions are preconditioned residuals and previous directions
+			basis.resize(n,residuals.cols()+directions.cols());
+			preconditioner.apply(residuals,basis.leftCols(residuals.cols()));
+			basis.rightCols(directions.cols()) = directions;
+			lobpcg_orthonormalize(basis,X);
+			if (basis.cols() == 0)
+			{
+				converged = true;
+				break;
+			}
+			operated_basis.resize(n,basis.cols());
+			operation.apply(basis,operated_basis);
+		}
+
+		if (converged)
+		{
+			std::string message = formatting::format("Took {} iterations.", iteration);
+			LoggingSingleton::instance().message_info(message);
+		}
+		else
+		{
+			std::string message = formatting::format("LOBPCG has not converged in {} iterations.", iteration);
+			LoggingSingleton::instance().message_warning(message);
+		}
+
+		X = largest ? X.rightCols(nev).eval() : X.leftCols(nev).eval();
+		theta = largest ? theta.tail(nev).eval() : theta.head(nev).eval();
+	}
+
+	return select_eigenpairs(X,theta,target_dimension,skip,largest);
+}
+
+//! Estimates upper bound of the spectrum of the (possibly negated) 
+//! operation with a few steps of the Lanczos process.
+//!
+//! @param operation operation to be estimated
+//! @param n size of the problem
+//! @param sign sign the operation is multiplied with
+//! @param steps number of Lanczos steps
+//!
+template <class MatrixOperationType>
+ScalarType lanczos_upper_bound(MatrixOperationType& operation, IndexType n, ScalarType sign, IndexType steps)
+{
+	steps = std::min(steps,n);
+	DenseVector v(n);
+	for (IndexType i=0; i<n; ++i)
+		v(i) = tapkee::gaussian_random();
+	v.normalize();
+	DenseVector previous = DenseVector::Zero(n);
+	DenseVector f(n);
+	DenseMatrix tridiagonal = DenseMatrix::Zero(steps,steps);
+	ScalarType beta = 0.0;
+	IndexType j = 0;
+	for (; j<steps; ++j)
+	{
+		operation.apply(v,f);
+		f *= sign;
+		f -= beta*previous;
+		ScalarType alpha = f.dot(v);
+		f -= alpha*v;
+		tridiagonal(j,j) = alpha;
+		beta = f.norm();
+		if (j+1 == steps || beta < 1e-12)
+			break;
+		tridiagonal(j+1,j) = tridiagonal(j,j+1) = beta;
+		previous = v;
+		v = f/beta;
+	}
+	DenseMatrix computed = tridiagonal.topLeftCorner(j+1,j+1);
+	DenseSelfAdjointEigenSolver solver(computed);
+	return solver.eigenvalues().maxCoeff() + beta;
+}
+
+//! Chebyshev filtered subspace iteration implementation of eigendecomposition-based 
+//! embedding. The wanted eigenvalues are at the lower edge of the spectrum
+//! and the rest of the spectrum is damped with a Chebyshev polynomial so 
+//! only products of the operation with blocks of vectors are required and
+//! no factorization is performed. Spectrum bounds are estimated with 
+//! a few steps of the Lanczos process and Ritz values.
+//!
+//! @param wm matrix to be eigendecomposed
+//! @param target_dimension number of eigenvectors to be computed
+//! @param skip number of smallest eigenvectors to skip
+//! @param largest whether largest or smallest eigenvalues of the operation 
+//!        should be computed
+//!
+template <class MatrixType, class MatrixOperationType> 
+EigendecompositionResult eigendecomposition_impl_chebyshev(const MatrixType& wm, IndexType target_dimension, 
+                                                           unsigned int skip, bool largest)
+{
+	timed_context context("Chebyshev filtered subspace iteration eigendecomposition");
+
+	const IndexType n = wm.rows();
+	const IndexType nev = target_dimension + skip;
+	// some extra vectors in the block improve convergence of the wanted ones
+	const IndexType block_size = std::min(n, nev + std::max(nev, IndexType(8)));
+	const IndexType degree = 16;
+	const IndexType max_iterations = 1000;
+	const ScalarType tolerance = 1e-9;
+	// largest eigenvalues are the smallest ones of the negated operation
+	const ScalarType sign = largest ? -1.0 : 1.0;
+
+	MatrixOperationType operation(wm);
+
+	DenseMatrix X;
+	DenseVector theta;
+
+	if (2*block_size >= n)
+	{
+		LoggingSingleton::instance().message_info("Problem is too small for Chebyshev filtering, solving it directly.");
+		direct_eigenpairs(operation,n,nev,largest,X,theta);
+		return select_eigenpairs(X,theta,target_dimension,skip,largest);
+	}
+
+	const ScalarType upper_bound = lanczos_upper_bound(operation,n,sign,IndexType(20));
+
+	X.resize(n,block_size);
+	for (IndexType i=0; i<n; ++i)
+	{
+		for (IndexType j=0; j<block_size; j++)
+			X(i,j) = tapkee::gaussian_random();
+	}
+
+	DenseMatrix AX(n,block_size);
+	DenseMatrix previous(n,block_size);
+	DenseMatrix current(n,block_size);
+	DenseMatrix next(n,block_size);
+	ScalarType lower_bound = 0.0;
+	ScalarType cutoff = 0.0;
+	bool filter = false;
+	bool converged = false;
+	IndexType iteration = 0;
+
+	for (; iteration<max_iterations; ++iteration)
+	{
+		if (filter)
+		{
+			// scaled three-term recurrence of the Chebyshev polynomial 
+			// mapping [cutoff, upper_bound] to [-1,1]
+			const ScalarType e = (upper_bound - cutoff)/2;
+			const ScalarType c = (upper_bound + cutoff)/2;
+			ScalarType sigma = e/(lower_bound - c);
+			const ScalarType tau = 2/sigma;
+			previous = X;
+			operation.apply(previous,current);
+			current = (sign*current - c*previous)*(sigma/e);
+			for (IndexType i=1; i<degree; ++i)
+			{
+				ScalarType next_sigma = 1/(tau - sigma);
+				operation.apply(current,next);
+				next = (sign*next - c*current)*(2*next_sigma/e) - (sigma*next_sigma)*previous;
+				previous.swap(current);
+				current.swap(next);
+				sigma = next_sigma;
+			}
+			X = current;
+		}
+
+		// orthonormalize the filtered block keeping its size
+		Eigen::HouseholderQR<DenseMatrix> qr(X);
+		X = qr.householderQ()*DenseMatrix::Identity(n,block_size);
+		operation.apply(X,AX);
+		AX *= sign;
+
+		// Rayleigh-Ritz procedure
+		DenseMatrix projected = X.transpose()*AX;
+		projected = 0.5*(projected + projected.transpose()).eval();
+		DenseSelfAdjointEigenSolver ritz(projected);
+		if (ritz.info() != Eigen::Success)
+			throw eigendecomposition_error("eigendecomposition failed");
+		theta = ritz.eigenvalues();
+		X = X*ritz.eigenvectors();
+		AX = AX*ritz.eigenvectors();
+
+		lower_bound = filter ? std::min(lower_bound,theta(0)) : theta(0);
+		cutoff = theta(block_size-1);
+		filter = true;
+
+		ScalarType max_residual = 0.0;
+		for (IndexType j=0; j<nev; ++j)
+			max_residual = std::max(max_residual, (AX.col(j) - theta(j)*X.col(j)).norm());
+		ScalarType scale = std::max(std::abs(upper_bound),std::abs(lower_bound));
+		if (max_residual <= tolerance*std::max(scale,ScalarType(1e-12)))
+		{
+			converged = true;
+			break;
+		}
+		// the filter degenerates if the cutoff reaches the upper bound
+		if (cutoff >= upper_bound)
+			throw eigendecomposition_error("Chebyshev filter failed to separate the spectrum");
+	}
+
+	if (converged)
+	{
+		std::string message = formatting::format("Took {} iterations.", iteration);
+		LoggingSingleton::instance().message_info(message);
+	}
+	else
+	{
+		std::string message = formatting::format("Chebyshev filtered subspace iteration has not converged in {} iterations.", iteration);
+		LoggingSingleton::instance().message_warning(message);
+	}
+
+	// wanted eigenpairs in ascending order of eigenvalues of the operation
+	DenseMatrix eigenvectors(n,nev);
+	DenseVector eigenvalues(nev);
+	for (IndexType j=0; j<nev; ++j)
+	{
+		IndexType k = largest ? nev-1-j : j;
+		eigenvectors.col(j) = X.col(k);
+		eigenvalues(j) = sign*theta(k);
+	}
+	return select_eigenpairs(eigenvectors,eigenvalues,target_dimension,skip,largest);
+}
+
 template <typename MatrixType>
 struct eigendecomposition_impl
 {
@@ -152,6 +666,12 @@ struct eigendecomposition_impl
 	EigendecompositionResult randomized(const MatrixType& m, const ComputationStrategy& strategy, 
                                         const EigendecompositionStrategy& eigen_strategy, 
                                         IndexType target_dimension);
+	EigendecompositionResult lobpcg(const MatrixType& m, const ComputationStrategy& strategy, 
+                                    const EigendecompositionStrategy& eigen_strategy, 
+                                    IndexType target_dimension);
+	EigendecompositionResult chebyshev(const MatrixType& m, const ComputationStrategy& strategy, 
+                                       const EigendecompositionStrategy& eigen_strategy, 
+                                       IndexType target_dimension);
 };
 
 template <>
@@ -243,6 +763,46 @@ struct eigendecomposition_impl<DenseMatrix>
 		unsupported();
 		return EigendecompositionResult();
 	}
+	EigendecompositionResult lobpcg(const DenseMatrix& m, const ComputationStrategy& strategy, 
+                                    const EigendecompositionStrategy& eigen_strategy, 
+                                    IndexType target_dimension)
+	{
+		if (strategy.is(HomogeneousCPUStrategy))
+		{
+			if (eigen_strategy.is(LargestEigenvalues))
+				return eigendecomposition_impl_lobpcg<DenseMatrix,DenseMatrixOperation>
+					(m,target_dimension,eigen_strategy.skip(),true,IdentityPreconditioner());
+			if (eigen_strategy.is(SquaredLargestEigenvalues))
+				return eigendecomposition_impl_lobpcg<DenseMatrix,DenseImplicitSquareMatrixOperation>
+					(m,target_dimension,eigen_strategy.skip(),true,IdentityPreconditioner());
+			if (eigen_strategy.is(SmallestEigenvalues))
+				return eigendecomposition_impl_lobpcg<DenseMatrix,DenseMatrixOperation>
+					(m,target_dimension,eigen_strategy.skip(),false,IdentityPreconditioner());
+			unsupported();
+		}
+		unsupported();
+		return EigendecompositionResult();
+	}
+	EigendecompositionResult chebyshev(const DenseMatrix& m, const ComputationStrategy& strategy, 
+                                       const EigendecompositionStrategy& eigen_strategy, 
+                                       IndexType target_dimension)
+	{
+		if (strategy.is(HomogeneousCPUStrategy))
+		{
+			if (eigen_strategy.is(LargestEigenvalues))
+				return eigendecomposition_impl_chebyshev<DenseMatrix,DenseMatrixOperation>
+					(m,target_dimension,eigen_strategy.skip(),true);
+			if (eigen_strategy.is(SquaredLargestEigenvalues))
+				return eigendecomposition_impl_chebyshev<DenseMatrix,DenseImplicitSquareMatrixOperation>
+					(m,target_dimension,eigen_strategy.skip(),true);
+			if (eigen_strategy.is(SmallestEigenvalues))
+				return eigendecomposition_impl_chebyshev<DenseMatrix,DenseMatrixOperation>
+					(m,target_dimension,eigen_strategy.skip(),false);
+			unsupported();
+		}
+		unsupported();
+		return EigendecompositionResult();
+	}
 	inline void unsupported() const 
 	{
 		throw unsupported_method_error("Unsupported method");
@@ -259,6 +819,14 @@ struct eigendecomposition_impl<SparseWeightMatrix>
 	{
 		if (strategy.is(HomogeneousCPUStrategy))
 		{
+			if (eigen_strategy.is(LargestEigenvalues))
+				return eigendecomposition_impl_arpack<SparseWeightMatrix,SparseMatrixOperation>
+					(m,target_dimension,eigen_strategy.skip());
+			// if the skipped eigenvector spans the constant nullspace
+			// it is deflated explicitly instead
+			if (eigen_strategy.is(SmallestEigenvalues) && has_constant_nullspace(m))
+				return eigendecomposition_impl_deflated(Arpack,
+					DeflatedSparseMatrix(m,DenseVector::Ones(m.rows()),deflation_shift(m)),target_dimension);
 			if (eigen_strategy.is(SmallestEigenvalues))
 				return eigendecomposition_impl_arpack<SparseWeightMatrix,SparseInverseMatrixOperation>
 					(m,target_dimension,eigen_strategy.skip());
@@ -274,6 +842,9 @@ struct eigendecomposition_impl<SparseWeightMatrix>
 	{
 		if (strategy.is(HomogeneousCPUStrategy))
 		{
+			if (eigen_strategy.is(LargestEigenvalues))
+				return eigendecomposition_impl_dense<SparseWeightMatrix,SparseMatrixOperation>
+					(m,target_dimension,eigen_strategy.skip());
 			if (eigen_strategy.is(SmallestEigenvalues))
 				return eigendecomposition_impl_dense<SparseWeightMatrix,SparseInverseMatrixOperation>
 					(m,target_dimension,eigen_strategy.skip());
@@ -288,6 +859,14 @@ struct eigendecomposition_impl<SparseWeightMatrix>
 	{
 		if (strategy.is(HomogeneousCPUStrategy))
 		{
+			if (eigen_strategy.is(LargestEigenvalues))
+				return eigendecomposition_impl_randomized<SparseWeightMatrix,SparseMatrixOperation>
+					(m,target_dimension,eigen_strategy.skip());
+			// if the skipped eigenvector spans the constant nullspace
+			// it is deflated explicitly instead
+			if (eigen_strategy.is(SmallestEigenvalues) && has_constant_nullspace(m))
+				return eigendecomposition_impl_deflated(Randomized,
+					DeflatedSparseMatrix(m,DenseVector::Ones(m.rows()),deflation_shift(m)),target_dimension);
 			if (eigen_strategy.is(SmallestEigenvalues))
 				return eigendecomposition_impl_randomized<SparseWeightMatrix,SparseInverseMatrixOperation>
 					(m,target_dimension,eigen_strategy.skip());
@@ -296,6 +875,43 @@ struct eigendecomposition_impl<SparseWeightMatrix>
 		unsupported();
 		return EigendecompositionResult();
 	}
+	EigendecompositionResult lobpcg(const SparseWeightMatrix& m, const ComputationStrategy& strategy, 
+                                    const EigendecompositionStrategy& eigen_strategy, 
+                                    IndexType target_dimension)
+	{
+		if (strategy.is(HomogeneousCPUStrategy))
+		{
+			if (eigen_strategy.is(LargestEigenvalues))
+				return eigendecomposition_impl_lobpcg<SparseWeightMatrix,SparseMatrixOperation>
+					(m,target_dimension,eigen_strategy.skip(),true,IdentityPreconditioner());
+			if (eigen_strategy.is(SmallestEigenvalues))
+			{
+				SmoothedAggregationPreconditioner preconditioner(m);
+				return eigendecomposition_impl_lobpcg<SparseWeightMatrix,SparseMatrixOperation>
+					(m,target_dimension,eigen_strategy.skip(),false,preconditioner);
+			}
+			unsupported();
+		}
+		unsupported();
+		return EigendecompositionResult();
+	}
+	EigendecompositionResult chebyshev(const SparseWeightMatrix& m, const ComputationStrategy& strategy, 
+                                       const EigendecompositionStrategy& eigen_strategy, 
+                                       IndexType target_dimension)
+	{
+		if (strategy.is(HomogeneousCPUStrategy))
+		{
+			if (eigen_strategy.is(LargestEigenvalues))
+				return eigendecomposition_impl_chebyshev<SparseWeightMatrix,SparseMatrixOperation>
+					(m,target_dimension,eigen_strategy.skip(),true);
+			if (eigen_strategy.is(SmallestEigenvalues))
+				return eigendecomposition_impl_chebyshev<SparseWeightMatrix,SparseMatrixOperation>
+					(m,target_dimension,eigen_strategy.skip(),false);
+			unsupported();
+		}
+		unsupported();
+		return EigendecompositionResult();
+	}
 	inline void unsupported() const 
 	{
 		throw unsupported_method_error("Unsupported method");
@@ -309,19 +925,22 @@ struct eigendecomposition_impl<SparseWeightMatrix>
 //! MatrixOperationType - class of product operation over matrix.
 //!
 //! In order to compute largest eigenvalues MatrixOperationType should provide
-//! implementation of operator()(DenseMatrix) which computes right product
-//! of the parameter with the MatrixType.
+//! implementation of apply(rhs,result) which computes right product
+//! of the parameter with the MatrixType and writes it to the provided 
+//! storage without allocating the result.
 //! 
 //! In order to compute smallest eigenvalues MatrixOperationType should provide
-//! implementation of operator()(DenseMatrix) which solves linear system with
-//! given right-hand side part. 
+//! implementation of apply(rhs,result) which solves linear system with
+//! given right-hand side part and writes the solution to the provided storage. 
 //! 
-//! Currently supports three methods:
+//! Currently supports five methods:
 //!
 //! <ul>
 //! <li> Arpack
 //! <li> Randomized
 //! <li> Dense
+//! <li> Lobpcg
+//! <li> ChebyshevFilter
 //! </ul>
 //!
 //! @param method one of supported eigendecomposition methods
@@ -345,6 +964,10 @@ EigendecompositionResult eigendecomposition(const EigenMethod& method, const Com
 		return eigendecomposition_impl<MatrixType>().randomized(m,strategy,eigen_strategy,target_dimension);
 	if (method.is(Dense))
 		return eigendecomposition_impl<MatrixType>().dense(m,strategy,eigen_strategy,target_dimension);
+	if (method.is(Lobpcg))
+		return eigendecomposition_impl<MatrixType>().lobpcg(m,strategy,eigen_strategy,target_dimension);
+	if (method.is(ChebyshevFilter))
+		return eigendecomposition_impl<MatrixType>().chebyshev(m,strategy,eigen_strategy,target_dimension);
 	return EigendecompositionResult();
 }
 
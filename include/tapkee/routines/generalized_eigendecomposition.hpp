@@ -11,6 +11,7 @@
 	#include <tapkee/utils/arpack_wrapper.hpp>
 #endif
 #include <tapkee/routines/matrix_operations.hpp>
+#include <tapkee/routines/eigendecomposition.hpp>
 /* End of Tapkee includes */
 
 namespace tapkee
@@ -89,6 +90,14 @@ struct generalized_eigendecomposition_impl
                                    const ComputationStrategy& strategy, 
                                    const EigendecompositionStrategy& eigen_strategy, 
                                    IndexType target_dimension);
+	EigendecompositionResult lobpcg(const LMatrixType& lhs, const RMatrixType& rhs,
+                                    const ComputationStrategy& strategy, 
+                                    const EigendecompositionStrategy& eigen_strategy, 
+                                    IndexType target_dimension);
+	EigendecompositionResult chebyshev(const LMatrixType& lhs, const RMatrixType& rhs,
+                                       const ComputationStrategy& strategy, 
+                                       const EigendecompositionStrategy& eigen_strategy, 
+                                       IndexType target_dimension);
 };
 
 template <>
@@ -102,6 +111,21 @@ struct generalized_eigendecomposition_impl<SparseWeightMatrix, DenseDiagonalMatr
 	{
 		if (strategy.is(HomogeneousCPUStrategy)) 
 		{
+			// If the skipped eigenvector spans the constant nullspace of lhs
+			// the problem is reduced to the standard one for the matrix 
+			// \f$ D^{-1/2} L D^{-1/2} \f$ with the nullspace spanned by 
+			// \f$ D^{1/2} 1 \f$, which is deflated explicitly.
+			if (eigen_strategy.is(SmallestEigenvalues) && has_constant_nullspace(lhs))
+			{
+				DenseVector sqrt_diagonal = rhs.diagonal().cwiseSqrt();
+				DenseVector inverse_sqrt_diagonal = sqrt_diagonal.cwiseInverse();
+				SparseWeightMatrix normalized = 
+					inverse_sqrt_diagonal.asDiagonal()*lhs*inverse_sqrt_diagonal.asDiagonal();
+				EigendecompositionResult result = eigendecomposition_impl_deflated(Arpack,
+					DeflatedSparseMatrix(normalized,sqrt_diagonal,deflation_shift(normalized)),target_dimension);
+				result.first = inverse_sqrt_diagonal.asDiagonal()*result.first;
+				return result;
+			}
 			if (eigen_strategy.is(SmallestEigenvalues))
 				return generalized_eigendecomposition_impl_arpack
 					<SparseWeightMatrix,DenseDiagonalMatrix,SparseInverseMatrixOperation>
@@ -128,6 +152,59 @@ struct generalized_eigendecomposition_impl<SparseWeightMatrix, DenseDiagonalMatr
 		unsupported();
 		return EigendecompositionResult();
 	}
+	EigendecompositionResult lobpcg(const SparseWeightMatrix& lhs, const DenseDiagonalMatrix& rhs,
+                                    const ComputationStrategy& strategy, 
+                                    const EigendecompositionStrategy& eigen_strategy, 
+                                    IndexType target_dimension)
+	{
+		if (strategy.is(HomogeneousCPUStrategy)) 
+		{
+			// The problem is reduced to the standard one for the matrix
+			// \f$ D^{-1/2} L D^{-1/2} \f$ preconditioned with the multigrid
+			// built for the near-nullspace vector \f$ D^{1/2} 1 \f$
+			if (eigen_strategy.is(SmallestEigenvalues))
+			{
+				DenseVector sqrt_diagonal = rhs.diagonal().cwiseSqrt();
+				DenseVector inverse_sqrt_diagonal = sqrt_diagonal.cwiseInverse();
+				SparseWeightMatrix normalized = 
+					inverse_sqrt_diagonal.asDiagonal()*lhs*inverse_sqrt_diagonal.asDiagonal();
+				SmoothedAggregationPreconditioner preconditioner(normalized,sqrt_diagonal);
+				EigendecompositionResult result = 
+					eigendecomposition_impl_lobpcg<SparseWeightMatrix,SparseMatrixOperation>
+					(normalized,target_dimension,eigen_strategy.skip(),false,preconditioner);
+				result.first = inverse_sqrt_diagonal.asDiagonal()*result.first;
+				return result;
+			}
+			unsupported();
+		}
+		unsupported();
+		return EigendecompositionResult();
+	}
+	EigendecompositionResult chebyshev(const SparseWeightMatrix& lhs, const DenseDiagonalMatrix& rhs,
+                                       const ComputationStrategy& strategy, 
+                                       const EigendecompositionStrategy& eigen_strategy, 
+                                       IndexType target_dimension)
+	{
+		if (strategy.is(HomogeneousCPUStrategy)) 
+		{
+			// The problem is reduced to the standard one for the matrix
+			// \f$ D^{-1/2} L D^{-1/2} \f$ which only requires sparse products
+			if (eigen_strategy.is(SmallestEigenvalues))
+			{
+				DenseVector inverse_sqrt_diagonal = rhs.diagonal().cwiseSqrt().cwiseInverse();
+				SparseWeightMatrix normalized = 
+					inverse_sqrt_diagonal.asDiagonal()*lhs*inverse_sqrt_diagonal.asDiagonal();
+				EigendecompositionResult result = 
+					eigendecomposition_impl_chebyshev<SparseWeightMatrix,SparseMatrixOperation>
+					(normalized,target_dimension,eigen_strategy.skip(),false);
+				result.first = inverse_sqrt_diagonal.asDiagonal()*result.first;
+				return result;
+			}
+			unsupported();
+		}
+		unsupported();
+		return EigendecompositionResult();
+	}
 	inline void unsupported() const 
 	{
 		throw unsupported_method_error("Unsupported method");
@@ -171,6 +248,22 @@ struct generalized_eigendecomposition_impl<DenseMatrix, DenseMatrix>
 		unsupported();
 		return EigendecompositionResult();
 	}
+	EigendecompositionResult lobpcg(const DenseMatrix&, const DenseMatrix&,
+                                    const ComputationStrategy&, 
+                                    const EigendecompositionStrategy&, 
+                                    IndexType)
+	{
+		unsupported();
+		return EigendecompositionResult();
+	}
+	EigendecompositionResult chebyshev(const DenseMatrix&, const DenseMatrix&,
+                                       const ComputationStrategy&, 
+                                       const EigendecompositionStrategy&, 
+                                       IndexType)
+	{
+		unsupported();
+		return EigendecompositionResult();
+	}
 	inline void unsupported() const 
 	{
 		throw unsupported_method_error("Unsupported method");
@@ -194,6 +287,12 @@ EigendecompositionResult generalized_eigendecomposition(const EigenMethod& metho
 			.dense(lhs, rhs, strategy, eigen_strategy, target_dimension);
 	if (method.is(Randomized))
 		throw unsupported_method_error("Randomized method is not supported for generalized eigenproblems");
+	if (method.is(Lobpcg))
+		return generalized_eigendecomposition_impl<LMatrixType, RMatrixType>()
+			.lobpcg(lhs, rhs, strategy, eigen_strategy, target_dimension);
+	if (method.is(ChebyshevFilter))
+		return generalized_eigendecomposition_impl<LMatrixType, RMatrixType>()
+			.chebyshev(lhs, rhs, strategy, eigen_strategy, target_dimension);
 	return EigendecompositionResult();
 }
 
@@ -9,8 +9,13 @@
 /* Tapkee includes */
 #include <tapkee/defines.hpp>
 #include <tapkee/utils/time.hpp>
+#include <tapkee/utils/sparse.hpp>
+#include <tapkee/routines/eigendecomposition.hpp>
 /* End of Tapkee includes */
 
+#include <vector>
+#include <algorithm>
+
 namespace tapkee
 {
 namespace tapkee_internal
@@ -109,6 +114,194 @@ DenseSymmetricMatrixPair construct_locality_preserving_eigenproblem(SparseWeight
 	return DenseSymmetricMatrixPair(lhs,rhs);
 }
 
+//! Compares indices by corresponding values
+struct IndexValueComparator
+{
+	IndexValueComparator(const DenseVector& v) : values(v) {}
+	inline bool operator()(IndexType a, IndexType b) const
+	{
+		return values(a) < values(b);
+	}
+	const DenseVector& values;
+};
+
+//! Computes weights of the nearest anchors of a vector. Weights
+//! are gaussian exps of squared distances normalized to sum to one.
+//! The exps are shifted with the distance to the nearest anchor
+//! which doesn't change normalized weights but avoids underflows.
+//!
+//! @param distances distances from the vector to all anchors
+//! @param n_nearest number of nearest anchors \f$ s \f$
+//! @param width width \f$ w \f$ of the gaussian kernel
+//! @param order workspace of the size of the number of anchors
+//! @param indices storage for indices of the nearest anchors
+//! @param weights storage for weights of the nearest anchors
+//!
+inline void compute_anchor_weights(const DenseVector& distances, IndexType n_nearest, ScalarType width,
+                                   std::vector<IndexType>& order, IndexType* indices, ScalarType* weights)
+{
+	for (IndexType j=0; j<static_cast<IndexType>(order.size()); ++j)
+		order[j] = j;
+	std::partial_sort(order.begin(),order.begin()+n_nearest,order.end(),
+	                  IndexValueComparator(distances));
+
+	const ScalarType nearest = distances(order[0])*distances(order[0]);
+	ScalarType sum = 0.0;
+	for (IndexType j=0; j<n_nearest; ++j)
+	{
+		indices[j] = order[j];
+		weights[j] = exp(-(distances(order[j])*distances(order[j]) - nearest)/width);
+		sum += weights[j];
+	}
+	for (IndexType j=0; j<n_nearest; ++j)
+		weights[j] /= sum;
+}
+
+//! Computes the anchor graph, i.e. the sparse matrix \f$ Z \f$ such that
+//! the \f$ i \f$-th row contains weights of \f$ s \f$ anchors nearest
+//! to the \f$ i \f$-th vector (see @ref compute_anchor_weights). Rows 
+//! are computed in parallel with \f$ O(m) \f$ distance evaluations each.
+//!
+//! @param begin begin data iterator
+//! @param end end data iterator
+//! @param anchors indices of anchors
+//! @param callback distance callback
+//! @param n_nearest number of nearest anchors \f$ s \f$
+//! @param width width \f$ w \f$ of the gaussian kernel
+//!
+template<class RandomAccessIterator, class DistanceCallback>
+SparseWeightMatrix compute_anchor_graph(RandomAccessIterator begin, RandomAccessIterator end,
+                                        const Landmarks& anchors, DistanceCallback callback,
+                                        IndexType n_nearest, ScalarType width)
+{
+	timed_context context("Anchor graph computation");
+
+	const IndexType n_vectors = end-begin;
+	const IndexType n_anchors = anchors.size();
+	std::vector<IndexType> indices(n_vectors*n_nearest);
+	std::vector<ScalarType> weights(n_vectors*n_nearest);
+
+#pragma omp parallel
+	{
+		DenseVector distances(n_anchors);
+		std::vector<IndexType> order(n_anchors);
+#pragma omp for
+		for (IndexType i=0; i<n_vectors; ++i)
+		{
+			for (IndexType j=0; j<n_anchors; ++j)
+				distances(j) = callback.distance(begin[i],begin[anchors[j]]);
+			compute_anchor_weights(distances,n_nearest,width,order,
+			                       &indices[i*n_nearest],&weights[i*n_nearest]);
+		}
+	}
+
+	SparseTriplets sparse_triplets;
+	sparse_triplets.reserve(n_vectors*n_nearest);
+	for (IndexType i=0; i<n_vectors; ++i)
+	{
+		for (IndexType j=0; j<n_nearest; ++j)
+			sparse_triplets.push_back(SparseTriplet(i,indices[i*n_nearest+j],weights[i*n_nearest+j]));
+	}
+	return sparse_matrix_from_triplets(sparse_triplets,n_vectors,n_anchors);
+}
+
+//! Computes the anchor graph Laplacian Eigenmaps embedding of anchors.
+//!
+//! The graph with adjacency \f$ W = Z \Lambda^{-1} Z^T \f$, where
+//! \f$ \Lambda = \mathrm{diag}(Z^T 1) \f$, has unit degrees so the smallest
+//! eigenvectors of its Laplacian are the largest eigenvectors of \f$ W \f$.
+//! These are \f$ Z \Lambda^{-1/2} v / \sqrt{\sigma} \f$ for eigenpairs 
+//! \f$ (\sigma, v) \f$ of the small \f$ m \times m \f$ matrix
+//! \f$ \Lambda^{-1/2} Z^T Z \Lambda^{-1/2} \f$. The top (constant) eigenvector 
+//! is dropped.
+//!
+//! Returns \f$ m \times t \f$ matrix \f$ P \f$ such that the embedding 
+//! of vectors is \f$ Z P \f$.
+//!
+//! @param anchor_graph matrix \f$ Z \f$
+//! @param eigen_method eigendecomposition method
+//! @param strategy computation strategy
+//! @param target_dimension target dimension \f$ t \f$
+//!
+inline DenseMatrix compute_anchors_embedding(const SparseWeightMatrix& anchor_graph, const EigenMethod& eigen_method,
+                                             const ComputationStrategy& strategy, IndexType target_dimension)
+{
+	timed_context context("Anchor graph eigenproblem");
+
+	const IndexType n_anchors = anchor_graph.cols();
+	DenseVector inverse_sqrt_degrees = DenseVector::Zero(n_anchors);
+	for (IndexType j=0; j<n_anchors; ++j)
+	{
+		ScalarType degree = anchor_graph.col(j).sum();
+		if (degree > 0.0)
+			inverse_sqrt_degrees(j) = 1.0/sqrt(degree);
+	}
+
+	SparseWeightMatrix gram = anchor_graph.transpose()*anchor_graph;
+	DenseSymmetricMatrix reduced = inverse_sqrt_degrees.asDiagonal()*DenseMatrix(gram)*inverse_sqrt_degrees.asDiagonal();
+
+	EigendecompositionResult result = 
+		eigendecomposition(eigen_method,strategy,LargestEigenvalues,reduced,target_dimension+1);
+
+	// eigendecomposition methods differ in order of eigenpairs
+	// so they are sorted in the decreasing order of eigenvalues
+	DenseVector negated_eigenvalues = -result.second;
+	std::vector<IndexType> order(target_dimension+1);
+	for (IndexType i=0; i<=target_dimension; ++i)
+		order[i] = i;
+	std::sort(order.begin(),order.end(),IndexValueComparator(negated_eigenvalues));
+
+	DenseMatrix anchors_embedding(n_anchors,target_dimension);
+	for (IndexType i=0; i<target_dimension; ++i)
+	{
+		ScalarType eigenvalue = result.second(order[i+1]);
+		anchors_embedding.col(i) = inverse_sqrt_degrees.cwiseProduct(result.first.col(order[i+1]));
+		if (eigenvalue > 0.0)
+			anchors_embedding.col(i) /= sqrt(eigenvalue);
+	}
+	return anchors_embedding;
+}
+
+//! Out-of-sample extension of the anchor graph Laplacian Eigenmaps. 
+//! Connects the vector to its nearest anchors and combines their
+//! embedding. Distances to anchors are Euclidean distances between 
+//! feature vectors.
+struct AnchorGraphProjectionImplementation : public ProjectionImplementation
+{
+	AnchorGraphProjectionImplementation(const DenseMatrix& anchor_vectors, const DenseMatrix& embedding,
+	                                    IndexType n_nearest, ScalarType width) :
+		anchors(anchor_vectors), anchors_embedding(embedding), s(n_nearest), w(width)
+	{
+	}
+
+	virtual ~AnchorGraphProjectionImplementation()
+	{
+	}
+
+	virtual DenseVector project(const DenseVector& vec)
+	{
+		DenseVector distances = (anchors.colwise() - vec).colwise().norm().transpose();
+		std::vector<IndexType> order(anchors.cols());
+		std::vector<IndexType> indices(s);
+		std::vector<ScalarType> weights(s);
+		compute_anchor_weights(distances,s,w,order,&indices[0],&weights[0]);
+
+		DenseVector projected = DenseVector::Zero(anchors_embedding.cols());
+		for (IndexType j=0; j<s; ++j)
+			projected += weights[j]*anchors_embedding.row(indices[j]).transpose();
+		return projected;
+	}
+
+	//! feature vectors of anchors
+	DenseMatrix anchors;
+	//! embedding matrix of anchors
+	DenseMatrix anchors_embedding;
+	//! number of nearest anchors
+	IndexType s;
+	//! width of the gaussian kernel
+	ScalarType w;
+};
+
 }
 }
 
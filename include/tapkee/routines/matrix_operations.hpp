@@ -9,6 +9,7 @@
 
 /* Tapkee includes */
 #include <tapkee/defines.hpp>
+#include <tapkee/utils/sparse.hpp>
 /* End of Tapkee includes */
 
 #ifdef TAPKEE_WITH_VIENNACL
@@ -41,6 +42,14 @@ struct SparseInverseMatrixOperation
 	{
 		return solver.solve(operatee);
 	}
+	/** Solves linear system with provided right-hand side
+	 * writing the solution to the provided storage
+	 */
+	template <class InputType, class OutputType>
+	inline void apply(const Eigen::MatrixBase<InputType>& operatee, const Eigen::MatrixBase<OutputType>& result)
+	{
+		result.const_cast_derived() = solver.solve(operatee);
+	}
 	SparseSolver solver;
 	static const char* ARPACK_CODE;
 	static const bool largest;
@@ -48,6 +57,79 @@ struct SparseInverseMatrixOperation
 const char* SparseInverseMatrixOperation::ARPACK_CODE = "SM";
 const bool SparseInverseMatrixOperation::largest = false;
 
+//! Sparse symmetric positive semi-definite matrix with
+//! known one-dimensional nullspace and a shift used to
+//! compute its smallest non-trivial eigenvalues.
+//!
+struct DeflatedSparseMatrix
+{
+	typedef ScalarType Scalar;
+	typedef SparseWeightMatrix::Index Index;
+
+	DeflatedSparseMatrix(const SparseWeightMatrix& m, const DenseVector& n, ScalarType s) : 
+		matrix(m), nullspace(n.normalized()), sigma(s)
+	{
+	}
+	inline IndexType rows() const
+	{
+		return matrix.rows();
+	}
+	inline IndexType cols() const
+	{
+		return matrix.cols();
+	}
+	//! the matrix
+	const SparseWeightMatrix& matrix;
+	//! unit vector spanning the nullspace of the matrix
+	DenseVector nullspace;
+	//! negative shift \f$ \sigma \f$ of the shift-inverted operation
+	ScalarType sigma;
+};
+
+//! Matrix-matrix operation used to
+//! compute smallest non-trivial eigenvalues
+//! and associated eigenvectors of a sparse matrix
+//! with known nullspace. Essentially solves linear
+//! system with shifted matrix \f$ M - \sigma I \f$
+//! projecting the nullspace out of both the 
+//! right-hand side part and the solution, so the
+//! nullspace is mapped to zero eigenvalue and the 
+//! smallest non-trivial eigenvalues \f$ \lambda \f$ are mapped to 
+//! the largest ones \f$ \frac{1}{\lambda - \sigma} \f$.
+//!
+struct SparseDeflatedShiftInvertMatrixOperation
+{
+	SparseDeflatedShiftInvertMatrixOperation(const DeflatedSparseMatrix& deflated) : 
+		solver(), nullspace(deflated.nullspace), projected()
+	{
+		SparseWeightMatrix shifted = deflated.matrix;
+		for (IndexType i=0; i<shifted.rows(); ++i)
+			shifted.coeffRef(i,i) -= deflated.sigma;
+		solver.compute(shifted);
+		if (solver.info() != Eigen::Success)
+			throw eigendecomposition_error("factorization of the shifted matrix failed");
+	}
+	/** Solves shifted linear system with deflated right-hand side
+	 * writing the deflated solution to the provided storage
+	 */
+	template <class InputType, class OutputType>
+	inline void apply(const Eigen::MatrixBase<InputType>& operatee, const Eigen::MatrixBase<OutputType>& result)
+	{
+		OutputType& solution = result.const_cast_derived();
+		projected = operatee;
+		projected.noalias() -= nullspace*(nullspace.transpose()*projected);
+		solution = solver.solve(projected);
+		solution -= nullspace*(nullspace.transpose()*solution);
+	}
+	SparseSolver solver;
+	DenseVector nullspace;
+	DenseMatrix projected;
+	static const char* ARPACK_CODE;
+	static const bool largest;
+};
+const char* SparseDeflatedShiftInvertMatrixOperation::ARPACK_CODE = "LM";
+const bool SparseDeflatedShiftInvertMatrixOperation::largest = true;
+
 //! Matrix-matrix operation used to 
 //! compute smallest eigenvalues and 
 //! associated eigenvectors of a dense matrix
@@ -66,6 +148,14 @@ struct DenseInverseMatrixOperation
 	{
 		return solver.solve(operatee);
 	}
+	/** Solves linear system with provided right-hand side
+	 * writing the solution to the provided storage
+	 */
+	template <class InputType, class OutputType>
+	inline void apply(const Eigen::MatrixBase<InputType>& operatee, const Eigen::MatrixBase<OutputType>& result)
+	{
+		result.const_cast_derived() = solver.solve(operatee);
+	}
 	DenseSolver solver;
 	static const char* ARPACK_CODE;
 	static const bool largest;
@@ -93,6 +183,17 @@ struct DenseMatrixOperation
 	{
 		return _matrix.selfadjointView<Eigen::Upper>()*rhs;
 	}
+	//! Computes matrix product of the matrix and provided right-hand 
+	//! side matrix writing it to the provided storage
+	//! 
+	//! @param rhs right-hand size matrix
+	//! @param result storage for the product
+	//!
+	template <class InputType, class OutputType>
+	inline void apply(const Eigen::MatrixBase<InputType>& rhs, const Eigen::MatrixBase<OutputType>& result)
+	{
+		result.const_cast_derived().noalias() = _matrix.selfadjointView<Eigen::Upper>()*rhs;
+	}
 	const DenseMatrix& _matrix;
 	static const char* ARPACK_CODE;
 	static const bool largest;
@@ -100,6 +201,49 @@ struct DenseMatrixOperation
 const char* DenseMatrixOperation::ARPACK_CODE = "LM";
 const bool DenseMatrixOperation::largest = true;
 
+//! Matrix-matrix operation used to
+//! compute eigenvalues and associated
+//! eigenvectors of a symmetric sparse matrix.
+//! Essentially computes matrix product 
+//! with provided right-hand side part
+//! in parallel using only the upper 
+//! triangle of the matrix.
+//!
+struct SparseMatrixOperation
+{
+	SparseMatrixOperation(const SparseWeightMatrix& matrix) : _matrix(matrix)
+	{
+	}
+	//! Computes matrix product of the matrix and provided right-hand
+	//! side matrix
+	//!
+	//! @param rhs right-hand size matrix
+	//!
+	inline DenseMatrix operator()(const DenseMatrix& rhs)
+	{
+		DenseMatrix result(rhs.rows(),rhs.cols());
+		_matrix.multiply(rhs,result);
+		return result;
+	}
+	//! Computes matrix product of the matrix and provided right-hand
+	//! side matrix writing it to the provided storage
+	//!
+	//! @param rhs right-hand size matrix
+	//! @param result storage for the product
+	//!
+	template <class InputType, class OutputType>
+	inline void apply(const Eigen::MatrixBase<InputType>& rhs, const Eigen::MatrixBase<OutputType>& result)
+	{
+		_matrix.multiply(rhs,result);
+	}
+	//! symmetric matrix with only upper triangle stored
+	SymmetricSparseMatrix _matrix;
+	static const char* ARPACK_CODE;
+	static const bool largest;
+};
+const char* SparseMatrixOperation::ARPACK_CODE = "LM";
+const bool SparseMatrixOperation::largest = true;
+
 //! Matrix-matrix operation used to
 //! compute largest eigenvalues and
 //! associated eigenvectors of X*X^T like
@@ -109,7 +253,7 @@ const bool DenseMatrixOperation::largest = true;
 //!
 struct DenseImplicitSquareSymmetricMatrixOperation
 {
-	DenseImplicitSquareSymmetricMatrixOperation(const DenseMatrix& matrix) : _matrix(matrix)
+	DenseImplicitSquareSymmetricMatrixOperation(const DenseMatrix& matrix) : _matrix(matrix), _intermediate()
 	{
 	}
 	//! Computes matrix product of the matrix and provided right-hand 
@@ -121,7 +265,21 @@ struct DenseImplicitSquareSymmetricMatrixOperation
 	{
 		return _matrix.selfadjointView<Eigen::Upper>()*(_matrix.selfadjointView<Eigen::Upper>()*rhs);
 	}
+	//! Computes matrix product of the matrix and provided right-hand 
+	//! side matrix twice writing it to the provided storage
+	//! 
+	//! @param rhs right-hand side matrix
+	//! @param result storage for the product
+	//!
+	template <class InputType, class OutputType>
+	inline void apply(const Eigen::MatrixBase<InputType>& rhs, const Eigen::MatrixBase<OutputType>& result)
+	{
+		_intermediate.resize(_matrix.rows(),rhs.cols());
+		_intermediate.noalias() = _matrix.selfadjointView<Eigen::Upper>()*rhs;
+		result.const_cast_derived().noalias() = _matrix.selfadjointView<Eigen::Upper>()*_intermediate;
+	}
 	const DenseMatrix& _matrix;
+	DenseMatrix _intermediate;
 	static const char* ARPACK_CODE;
 	static const bool largest;
 };
@@ -137,7 +295,7 @@ const bool DenseImplicitSquareSymmetricMatrixOperation::largest = true;
 //!
 struct DenseImplicitSquareMatrixOperation
 {
-	DenseImplicitSquareMatrixOperation(const DenseMatrix& matrix) : _matrix(matrix)
+	DenseImplicitSquareMatrixOperation(const DenseMatrix& matrix) : _matrix(matrix), _intermediate()
 	{
 	}
 	//! Computes matrix product of the matrix and provided right-hand 
@@ -149,7 +307,21 @@ struct DenseImplicitSquareMatrixOperation
 	{
 		return _matrix*(_matrix.transpose()*rhs);
 	}
+	//! Computes matrix product of the matrix and provided right-hand 
+	//! side matrix twice writing it to the provided storage
+	//! 
+	//! @param rhs right-hand side matrix
+	//! @param result storage for the product
+	//!
+	template <class InputType, class OutputType>
+	inline void apply(const Eigen::MatrixBase<InputType>& rhs, const Eigen::MatrixBase<OutputType>& result)
+	{
+		_intermediate.resize(_matrix.cols(),rhs.cols());
+		_intermediate.noalias() = _matrix.transpose()*rhs;
+		result.const_cast_derived().noalias() = _matrix*_intermediate;
+	}
 	const DenseMatrix& _matrix;
+	DenseMatrix _intermediate;
 	static const char* ARPACK_CODE;
 	static const bool largest;
 };
@@ -164,6 +336,7 @@ struct GPUDenseImplicitSquareMatrixOperation
 		mat = viennacl::matrix<ScalarType>(matrix.cols(),matrix.rows());
 		vec = viennacl::vector<ScalarType>(matrix.cols());
 		res = viennacl::vector<ScalarType>(matrix.cols());
+		host = DenseVector(matrix.cols());
 		viennacl::copy(matrix,mat);
 	}
 	//! Computes matrix product of the matrix and provided right-hand 
@@ -181,9 +354,30 @@ struct GPUDenseImplicitSquareMatrixOperation
 		viennacl::copy(res,result);
 		return result;
 	}
+	//! Computes matrix product of the matrix and provided right-hand 
+	//! side matrix twice writing it to the provided storage
+	//! 
+	//! @param rhs right-hand side matrix
+	//! @param result storage for the product
+	//!
+	template <class InputType, class OutputType>
+	inline void apply(const Eigen::MatrixBase<InputType>& rhs, const Eigen::MatrixBase<OutputType>& result)
+	{
+		for (IndexType i=0; i<static_cast<IndexType>(rhs.cols()); ++i)
+		{
+			host = rhs.col(i);
+			viennacl::copy(host,vec);
+			res = viennacl::linalg::prod(mat, vec);
+			vec = res;
+			res = viennacl::linalg::prod(mat, vec);
+			viennacl::copy(res,host);
+			result.const_cast_derived().col(i) = host;
+		}
+	}
 	viennacl::matrix<ScalarType> mat;
 	viennacl::vector<ScalarType> vec;
 	viennacl::vector<ScalarType> res;
+	DenseVector host;
 	static const char* ARPACK_CODE;
 	static const bool largest;
 };
@@ -197,6 +391,7 @@ struct GPUDenseMatrixOperation
 		mat = viennacl::matrix<ScalarType>(matrix.cols(),matrix.rows());
 		vec = viennacl::vector<ScalarType>(matrix.cols());
 		res = viennacl::vector<ScalarType>(matrix.cols());
+		host = DenseVector(matrix.cols());
 		viennacl::copy(matrix,mat);
 	}
 	//! Computes matrix product of the matrix and provided right-hand 
@@ -212,9 +407,28 @@ struct GPUDenseMatrixOperation
 		viennacl::copy(res,result);
 		return result;
 	}
+	//! Computes matrix product of the matrix and provided right-hand 
+	//! side matrix writing it to the provided storage
+	//! 
+	//! @param rhs right-hand side matrix
+	//! @param result storage for the product
+	//!
+	template <class InputType, class OutputType>
+	inline void apply(const Eigen::MatrixBase<InputType>& rhs, const Eigen::MatrixBase<OutputType>& result)
+	{
+		for (IndexType i=0; i<static_cast<IndexType>(rhs.cols()); ++i)
+		{
+			host = rhs.col(i);
+			viennacl::copy(host,vec);
+			res = viennacl::linalg::prod(mat, vec);
+			viennacl::copy(res,host);
+			result.const_cast_derived().col(i) = host;
+		}
+	}
 	viennacl::matrix<ScalarType> mat;
 	viennacl::vector<ScalarType> vec;
 	viennacl::vector<ScalarType> res;
+	DenseVector host;
 	static const char* ARPACK_CODE;
 	static const bool largest;
 };
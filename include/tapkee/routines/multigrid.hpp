@@ -0,0 +1,302 @@
+/* This software is distributed under BSD 3-clause license (see LICENSE file).
+ *
+ * Copyright (c) 2012-2013 Sergey Lisitsyn
+ */
+
+#ifndef TAPKEE_MULTIGRID_H_
+#define TAPKEE_MULTIGRID_H_
+
+/* Tapkee includes */
+#include <tapkee/defines.hpp>
+#include <tapkee/utils/sparse.hpp>
+/* End of Tapkee includes */
+
+#include <vector>
+
+namespace tapkee
+{
+namespace tapkee_internal
+{
+
+//! Smoothed aggregation algebraic multigrid preconditioner for
+//! sparse positive semi-definite matrices such as Laplacians and
+//! alignment matrices. One application of the preconditioner is
+//! one symmetric V-cycle, which approximates the (pseudo-)inverse
+//! of the matrix in time linear in the number of non-zeros.
+//!
+//! The hierarchy is constructed once:
+//!
+//! - nodes are grouped into aggregates of strongly connected neighbors,
+//! - the tentative prolongator interpolates the near-nullspace vector
+//!   piecewise over the aggregates,
+//! - the prolongator is the tentative one smoothed with a damped Jacobi step,
+//! - coarse matrices are Galerkin products \f$ P^T A P \f$.
+//!
+//! The coarsest matrix is small and is inverted densely with its
+//! nullspace ignored so singular matrices are handled gracefully.
+//!
+struct SmoothedAggregationPreconditioner
+{
+	//! Constructs the hierarchy for the matrix with the constant near-nullspace vector
+	//!
+	//! @param matrix symmetric positive semi-definite matrix
+	//!
+	SmoothedAggregationPreconditioner(const SparseWeightMatrix& matrix) :
+		levels(), coarse_inverse()
+	{
+		construct(matrix,DenseVector::Ones(matrix.rows()));
+	}
+	//! Constructs the hierarchy for the matrix with the provided near-nullspace vector
+	//!
+	//! @param matrix symmetric positive semi-definite matrix
+	//! @param near_nullspace vector the matrix (nearly) vanishes on, e.g.
+	//!        \f$ D^{1/2} 1 \f$ for normalized Laplacians
+	//!
+	SmoothedAggregationPreconditioner(const SparseWeightMatrix& matrix, const DenseVector& near_nullspace) :
+		levels(), coarse_inverse()
+	{
+		construct(matrix,near_nullspace);
+	}
+	//! Applies one V-cycle to each column of the provided block
+	//!
+	//! @param rhs block of right-hand sides
+	//! @param result storage for the preconditioned block
+	//!
+	template <class InputType, class OutputType>
+	inline void apply(const Eigen::MatrixBase<InputType>& rhs, const Eigen::MatrixBase<OutputType>& result) const
+	{
+		DenseMatrix block = rhs;
+		result.const_cast_derived() = cycle(0,block);
+	}
+	//! Returns number of levels in the hierarchy including the coarsest one
+	inline IndexType size() const
+	{
+		return static_cast<IndexType>(levels.size()) + 1;
+	}
+
+	struct Level
+	{
+		//! matrix of the level
+		SparseWeightMatrix matrix;
+		//! prolongator from the next coarser level
+		SparseWeightMatrix prolongator;
+		//! inverse of the diagonal scaled with the damping factor
+		DenseVector smoother;
+	};
+
+	std::vector<Level> levels;
+	DenseMatrix coarse_inverse;
+
+	//! Number of rows below which the matrix is inverted directly
+	static const IndexType coarse_size = 256;
+	//! Maximal number of levels
+	static const IndexType max_levels = 16;
+
+private:
+
+	DenseMatrix cycle(size_t level, const DenseMatrix& rhs) const
+	{
+		if (level == levels.size())
+			return coarse_inverse*rhs;
+
+		const Level& current = levels[level];
+		// pre-smoothing from the zero initial guess
+		DenseMatrix solution = current.smoother.asDiagonal()*rhs;
+		DenseMatrix residual = rhs;
+		residual.noalias() -= current.matrix*solution;
+		// coarse grid correction
+		DenseMatrix restricted = current.prolongator.transpose()*residual;
+		solution.noalias() += current.prolongator*cycle(level+1,restricted);
+		// post-smoothing
+		residual = rhs;
+		residual.noalias() -= current.matrix*solution;
+		solution.noalias() += current.smoother.asDiagonal()*residual;
+		return solution;
+	}
+
+	void construct(const SparseWeightMatrix& matrix, const DenseVector& near_nullspace)
+	{
+		timed_context context("Smoothed aggregation multigrid setup");
+
+		SparseWeightMatrix current = matrix;
+		DenseVector nullspace = near_nullspace;
+
+		while (current.rows() > coarse_size && static_cast<IndexType>(levels.size())+1 < max_levels)
+		{
+			std::vector<IndexType> aggregates;
+			IndexType n_aggregates = aggregate(current,aggregates);
+			// aggregation has stagnated, no reason to go deeper
+			if (n_aggregates == 0 || n_aggregates > (4*current.rows())/5)
+				break;
+
+			Level level;
+			level.matrix = current;
+			level.smoother = jacobi_smoother(current);
+
+			SparseWeightMatrix tentative = tentative_prolongator(aggregates,n_aggregates,nullspace);
+			SparseWeightMatrix operated = current*tentative;
+			level.prolongator = tentative - level.smoother.asDiagonal()*operated;
+			level.prolongator.prune(ScalarType(0.0));
+
+			nullspace = tentative.transpose()*nullspace;
+			current = level.prolongator.transpose()*(current*level.prolongator);
+			levels.push_back(level);
+		}
+
+		coarse_inverse = pseudo_inverse(current);
+
+		LoggingSingleton::instance().message_info(formatting::format(
+			"Multigrid hierarchy has {} levels, coarsest matrix is {}x{}.",
+			size(), current.rows(), current.cols()));
+	}
+
+	//! Groups nodes into aggregates of strongly connected neighbors.
+	//! Returns number of aggregates, the aggregate of each node is stored
+	//! in the provided vector.
+	static IndexType aggregate(const SparseWeightMatrix& matrix, std::vector<IndexType>& aggregates)
+	{
+		const IndexType n = matrix.rows();
+		const ScalarType threshold = 0.08;
+		const DenseVector diagonal = matrix.diagonal().cwiseAbs();
+
+		// the matrix is symmetric so columns are traversed instead of rows
+		std::vector<IndexType> offsets(n+1,0);
+		std::vector<IndexType> strong;
+		strong.reserve(matrix.nonZeros());
+		for (IndexType i=0; i<n; ++i)
+		{
+			for (SparseWeightMatrix::InnerIterator it(matrix,i); it; ++it)
+			{
+				IndexType j = it.row();
+				if (j != i && std::abs(it.value()) > threshold*std::sqrt(diagonal(i)*diagonal(j)))
+					strong.push_back(j);
+			}
+			offsets[i+1] = strong.size();
+		}
+
+		aggregates.assign(n,-1);
+		IndexType n_aggregates = 0;
+
+		// nodes with no aggregated neighbors form aggregates with their neighbors
+		for (IndexType i=0; i<n; ++i)
+		{
+			if (aggregates[i] != -1)
+				continue;
+			bool free = true;
+			for (IndexType k=offsets[i]; k<offsets[i+1] && free; ++k)
+				free = (aggregates[strong[k]] == -1);
+			if (!free)
+				continue;
+			aggregates[i] = n_aggregates;
+			for (IndexType k=offsets[i]; k<offsets[i+1]; ++k)
+				aggregates[strong[k]] = n_aggregates;
+			n_aggregates++;
+		}
+
+		// remaining nodes join aggregates of their neighbors
+		std::vector<IndexType> initial(aggregates);
+		for (IndexType i=0; i<n; ++i)
+		{
+			if (initial[i] != -1)
+				continue;
+			for (IndexType k=offsets[i]; k<offsets[i+1]; ++k)
+			{
+				if (initial[strong[k]] != -1)
+				{
+					aggregates[i] = initial[strong[k]];
+					break;
+				}
+			}
+		}
+
+		// and what is left forms new aggregates
+		for (IndexType i=0; i<n; ++i)
+		{
+			if (aggregates[i] != -1)
+				continue;
+			aggregates[i] = n_aggregates;
+			for (IndexType k=offsets[i]; k<offsets[i+1]; ++k)
+			{
+				if (aggregates[strong[k]] == -1)
+					aggregates[strong[k]] = n_aggregates;
+			}
+			n_aggregates++;
+		}
+
+		return n_aggregates;
+	}
+
+	//! Returns piecewise interpolation of the near-nullspace vector with
+	//! orthonormal columns
+	static SparseWeightMatrix tentative_prolongator(const std::vector<IndexType>& aggregates,
+	                                                IndexType n_aggregates, const DenseVector& nullspace)
+	{
+		const IndexType n = aggregates.size();
+		DenseVector norms = DenseVector::Zero(n_aggregates);
+		std::vector<IndexType> counts(n_aggregates,0);
+		for (IndexType i=0; i<n; ++i)
+		{
+			norms(aggregates[i]) += nullspace(i)*nullspace(i);
+			counts[aggregates[i]]++;
+		}
+
+		SparseTriplets triplets;
+		triplets.reserve(n);
+		for (IndexType i=0; i<n; ++i)
+		{
+			IndexType a = aggregates[i];
+			ScalarType value = (norms(a) > 0.0) ? nullspace(i)/std::sqrt(norms(a)) :
+			                                      1.0/std::sqrt(ScalarType(counts[a]));
+			triplets.push_back(SparseTriplet(i,a,value));
+		}
+		return sparse_matrix_from_triplets(triplets,n,n_aggregates);
+	}
+
+	//! Returns damped inverse of the diagonal. The damping factor is
+	//! \f$ 4/(3\rho) \f$ where \f$ \rho \f$ is the Gershgorin bound
+	//! of the spectral radius of \f$ D^{-1} A \f$.
+	static DenseVector jacobi_smoother(const SparseWeightMatrix& matrix)
+	{
+		const IndexType n = matrix.rows();
+		DenseVector inverse_diagonal(n);
+		ScalarType radius = 0.0;
+		for (IndexType i=0; i<n; ++i)
+		{
+			ScalarType diagonal = 0.0;
+			ScalarType sum = 0.0;
+			for (SparseWeightMatrix::InnerIterator it(matrix,i); it; ++it)
+			{
+				sum += std::abs(it.value());
+				if (it.row() == i)
+					diagonal = it.value();
+			}
+			inverse_diagonal(i) = (diagonal > 0.0) ? 1.0/diagonal : 0.0;
+			radius = std::max(radius, sum*inverse_diagonal(i));
+		}
+		if (radius > 0.0)
+			inverse_diagonal *= ScalarType(4.0)/(ScalarType(3.0)*radius);
+		return inverse_diagonal;
+	}
+
+	//! Returns pseudo-inverse of the (small) matrix
+	static DenseMatrix pseudo_inverse(const SparseWeightMatrix& matrix)
+	{
+		DenseMatrix dense = DenseMatrix(matrix);
+		dense = 0.5*(dense + dense.transpose()).eval();
+		DenseSelfAdjointEigenSolver solver(dense);
+		if (solver.info() != Eigen::Success)
+			throw eigendecomposition_error("eigendecomposition of the coarsest matrix failed");
+
+		const DenseVector& eigenvalues = solver.eigenvalues();
+		const ScalarType threshold = 1e-10*std::max(eigenvalues.cwiseAbs().maxCoeff(),ScalarType(1e-300));
+		DenseVector inverted(eigenvalues.size());
+		for (IndexType i=0; i<eigenvalues.size(); ++i)
+			inverted(i) = (std::abs(eigenvalues(i)) > threshold) ? 1.0/eigenvalues(i) : 0.0;
+		return solver.eigenvectors()*inverted.asDiagonal()*solver.eigenvectors().transpose();
+	}
+};
+
+} // End of namespace tapkee_internal
+} // End of namespace tapkee
+
+#endif
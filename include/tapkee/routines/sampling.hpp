@@ -0,0 +1,230 @@
+/* This software is distributed under BSD 3-clause license (see LICENSE file).
+ *
+ * Copyright (c) 2012-2013 Sergey Lisitsyn
+ */
+
+#ifndef TAPKEE_SAMPLING_H_
+#define TAPKEE_SAMPLING_H_
+
+/* Tapkee includes */
+#include <tapkee/defines.hpp>
+#include <tapkee/utils/time.hpp>
+/* End of Tapkee includes */
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+
+namespace tapkee
+{
+namespace tapkee_internal
+{
+
+//! Distance used to sample and interpolate. It is the distance
+//! callback if provided, the kernel-induced distance if only the
+//! kernel callback is provided and the Euclidean distance between
+//! feature vectors otherwise.
+template <bool with_distance, bool with_kernel>
+struct sampling_distance_impl
+{
+	template <class KernelCallback, class DistanceCallback, class FeaturesCallback, class T>
+	static inline ScalarType distance(KernelCallback&, DistanceCallback& distance, FeaturesCallback&,
+	                                  const T& l, const T& r)
+	{
+		return distance.distance(l,r);
+	}
+};
+
+template <>
+struct sampling_distance_impl<false,true>
+{
+	template <class KernelCallback, class DistanceCallback, class FeaturesCallback, class T>
+	static inline ScalarType distance(KernelCallback& kernel, DistanceCallback&, FeaturesCallback&,
+	                                  const T& l, const T& r)
+	{
+		return sqrt(std::max(ScalarType(0.0),kernel.kernel(l,l) - 2*kernel.kernel(l,r) + kernel.kernel(r,r)));
+	}
+};
+
+template <>
+struct sampling_distance_impl<false,false>
+{
+	template <class KernelCallback, class DistanceCallback, class FeaturesCallback, class T>
+	static inline ScalarType distance(KernelCallback&, DistanceCallback&, FeaturesCallback& features,
+	                                  const T& l, const T& r)
+	{
+		DenseVector l_vector(features.dimension());
+		DenseVector r_vector(features.dimension());
+		features.vector(l,l_vector);
+		features.vector(r,r_vector);
+		return (l_vector - r_vector).norm();
+	}
+};
+
+template <class KernelCallback, class DistanceCallback, class FeaturesCallback>
+struct SamplingDistance
+{
+	SamplingDistance(const KernelCallback& k, const DistanceCallback& d, const FeaturesCallback& f) :
+		kernel(k), distance_callback(d), features(f)
+	{
+	}
+	template <class T>
+	inline ScalarType distance(const T& l, const T& r)
+	{
+		return sampling_distance_impl<!is_dummy<DistanceCallback>::value,!is_dummy<KernelCallback>::value>
+			::distance(kernel,distance_callback,features,l,r);
+	}
+	KernelCallback kernel;
+	DistanceCallback distance_callback;
+	FeaturesCallback features;
+};
+
+//! Selects the sample of vectors uniformly at random.
+//!
+//! @param n_vectors number of vectors
+//! @param n_samples size of the sample
+//!
+inline Landmarks select_samples_uniform(IndexType n_vectors, IndexType n_samples)
+{
+	Landmarks samples(n_vectors);
+	for (IndexType i=0; i<n_vectors; ++i)
+		samples[i] = i;
+	tapkee::random_shuffle(samples.begin(),samples.end());
+	samples.erase(samples.begin()+n_samples,samples.end());
+	std::sort(samples.begin(),samples.end());
+	return samples;
+}
+
+//! Selects the sample of vectors with the farthest point heuristic:
+//! starting from a random vector each next sample is the vector
+//! farthest from already selected ones. Distances to the closest
+//! sample are updated in parallel, \f$ O(Nm) \f$ distances are computed.
+//!
+//! @param begin begin data iterator
+//! @param end end data iterator
+//! @param callback distance callback
+//! @param n_samples size of the sample
+//!
+template <class RandomAccessIterator, class DistanceCallback>
+Landmarks select_samples_farthest(RandomAccessIterator begin, RandomAccessIterator end,
+                                  DistanceCallback callback, IndexType n_samples)
+{
+	timed_context context("Farthest point sampling");
+
+	const IndexType n_vectors = end-begin;
+	DenseVector closest = DenseVector::Constant(n_vectors,std::numeric_limits<ScalarType>::max());
+	Landmarks samples;
+	samples.reserve(n_samples);
+	IndexType next = uniform_random_index_bounded(n_vectors);
+	for (IndexType s=0; s<n_samples; ++s)
+	{
+		samples.push_back(next);
+#pragma omp parallel for
+		for (IndexType i=0; i<n_vectors; ++i)
+			closest(i) = std::min(closest(i),callback.distance(begin[i],begin[next]));
+		closest.maxCoeff(&next);
+	}
+	std::sort(samples.begin(),samples.end());
+	return samples;
+}
+
+//! Embeds vectors that are not in the sample as a weighted combination
+//! of embedding of their nearest samples with weights inversely
+//! proportional to distances. Vectors are processed in parallel,
+//! each requires \f$ O(m) \f$ distances to the samples.
+//!
+//! @param begin begin data iterator
+//! @param end end data iterator
+//! @param samples sorted indices of samples
+//! @param samples_embedding embedding of samples
+//! @param callback distance callback
+//! @param n_neighbors number of nearest samples to use
+//! @param embedding embedding of all vectors, rows of
+//!        vectors not in the sample are filled
+//!
+template <class RandomAccessIterator, class DistanceCallback>
+void interpolate_embedding(RandomAccessIterator begin, RandomAccessIterator end, const Landmarks& samples,
+                           const DenseMatrix& samples_embedding, DistanceCallback callback,
+                           IndexType n_neighbors, DenseMatrix& embedding)
+{
+	timed_context context("Embedding interpolation");
+
+	const IndexType n_vectors = end-begin;
+	const IndexType n_samples = samples.size();
+	n_neighbors = std::min(n_neighbors,n_samples);
+
+	std::vector<bool> is_sample(n_vectors,false);
+	for (IndexType j=0; j<n_samples; ++j)
+		is_sample[samples[j]] = true;
+
+#pragma omp parallel
+	{
+		std::vector<std::pair<ScalarType,IndexType> > distances(n_samples);
+#pragma omp for schedule(dynamic,64)
+		for (IndexType i=0; i<n_vectors; ++i)
+		{
+			if (is_sample[i])
+				continue;
+
+			for (IndexType j=0; j<n_samples; ++j)
+				distances[j] = std::make_pair(callback.distance(begin[i],begin[samples[j]]),j);
+			std::partial_sort(distances.begin(),distances.begin()+n_neighbors,distances.end());
+
+			if (distances[0].first == 0.0)
+			{
+				embedding.row(i) = samples_embedding.row(distances[0].second);
+				continue;
+			}
+			ScalarType sum = 0.0;
+			embedding.row(i).setZero();
+			for (IndexType j=0; j<n_neighbors; ++j)
+			{
+				ScalarType weight = 1.0/distances[j].first;
+				embedding.row(i) += weight*samples_embedding.row(distances[j].second);
+				sum += weight;
+			}
+			embedding.row(i) /= sum;
+		}
+	}
+}
+
+//! Embeds vectors that are not in the sample with the projecting
+//! function of the method. Vectors are processed in parallel.
+//!
+//! @param begin begin data iterator
+//! @param end end data iterator
+//! @param samples sorted indices of samples
+//! @param features features callback
+//! @param projection projecting function
+//! @param embedding embedding of all vectors, rows of
+//!        vectors not in the sample are filled
+//!
+template <class RandomAccessIterator, class FeaturesCallback>
+void project_embedding(RandomAccessIterator begin, RandomAccessIterator end, const Landmarks& samples,
+                       FeaturesCallback features, ProjectingFunction projection, DenseMatrix& embedding)
+{
+	timed_context context("Embedding projection");
+
+	const IndexType n_vectors = end-begin;
+	std::vector<bool> is_sample(n_vectors,false);
+	for (IndexType j=0; j<static_cast<IndexType>(samples.size()); ++j)
+		is_sample[samples[j]] = true;
+
+#pragma omp parallel
+	{
+		DenseVector vector(features.dimension());
+#pragma omp for schedule(dynamic,64)
+		for (IndexType i=0; i<n_vectors; ++i)
+		{
+			if (is_sample[i])
+				continue;
+			features.vector(begin[i],vector);
+			embedding.row(i) = projection(vector).transpose();
+		}
+	}
+}
+
+}
+}
+
+#endif
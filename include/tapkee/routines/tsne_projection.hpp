@@ -0,0 +1,204 @@
+/* This software is distributed under BSD 3-clause license (see LICENSE file).
+ *
+ * Copyright (c) 2012-2013 Sergey Lisitsyn
+ */
+
+#ifndef TAPKEE_TSNE_PROJECTION_H_
+#define TAPKEE_TSNE_PROJECTION_H_
+
+/* Tapkee includes */
+#include <tapkee/defines.hpp>
+#include <tapkee/utils/time.hpp>
+#include <tapkee/neighbors/balltree.hpp>
+/* End of Tapkee includes */
+
+#include <vector>
+#include <cmath>
+#include <cfloat>
+
+namespace tapkee
+{
+namespace tapkee_internal
+{
+
+//! Places new vectors into a fixed t-SNE embedding.
+//!
+//! Keeps a ball tree over (normalized) training vectors together with
+//! their embedding. For each new vector input affinities to its nearest
+//! training vectors are calibrated to the perplexity just like in t-SNE,
+//! the vector is initialized at the affinity-weighted mean of its
+//! neighbors' embedding and then optimized with a short gradient descent
+//! while the training embedding stays fixed. Since training vectors are
+//! not moved, new vectors are independent and are processed in parallel.
+//!
+//! Repulsive forces are computed exactly so each iteration costs
+//! \f$ O(N) \f$ per new vector.
+//!
+struct TSNEProjectionImplementation : public ProjectionImplementation
+{
+	//! @param normalized_data training vectors in columns, normalized
+	//!        just like t-SNE does (centered and divided by scale)
+	//! @param data_mean mean that was subtracted from training vectors
+	//! @param data_scale scale training vectors were divided by
+	//! @param tsne_embedding training embedding with vectors in columns
+	//! @param tsne_perplexity perplexity used to compute affinities
+	//! @param iterations number of gradient descent iterations
+	//!
+	TSNEProjectionImplementation(const DenseMatrix& normalized_data, const DenseVector& data_mean,
+	                             ScalarType data_scale, const DenseMatrix& tsne_embedding,
+	                             ScalarType tsne_perplexity, IndexType iterations=100) :
+		tree(normalized_data), mean(data_mean), scale(data_scale), embedding(tsne_embedding),
+		perplexity(tsne_perplexity), n_iterations(iterations)
+	{
+		n_neighbors = std::min(static_cast<IndexType>(3*perplexity),static_cast<IndexType>(embedding.cols()));
+	}
+
+	virtual ~TSNEProjectionImplementation()
+	{
+	}
+
+	virtual DenseVector project(const DenseVector& vec)
+	{
+		return place((vec - mean)/scale);
+	}
+
+	//! Projects a batch of vectors in parallel
+	//! @param vectors matrix with vectors to be projected in columns
+	//! @return matrix with projected vectors in rows
+	DenseMatrix project_batch(const DenseMatrix& vectors)
+	{
+		timed_context context("t-SNE projection");
+
+		const IndexType n = vectors.cols();
+		DenseMatrix projected(n,embedding.rows());
+#pragma omp parallel for schedule(dynamic)
+		for (IndexType i=0; i<n; ++i)
+			projected.row(i) = place((vectors.col(i) - mean)/scale).transpose();
+		return projected;
+	}
+
+	//! ball tree over normalized training vectors
+	MetricBallTree tree;
+	//! mean of training vectors
+	DenseVector mean;
+	//! scale of centered training vectors
+	ScalarType scale;
+	//! training embedding (vectors in columns)
+	DenseMatrix embedding;
+	//! perplexity of affinities
+	ScalarType perplexity;
+	//! number of nearest training vectors
+	IndexType n_neighbors;
+	//! number of gradient descent iterations
+	IndexType n_iterations;
+
+private:
+
+	//! Computes affinities of the normalized vector to its nearest
+	//! training vectors with the binary search over precision
+	void affinities(const DenseVector& vec, std::vector<IndexType>& indices, DenseVector& p) const
+	{
+		NearestCandidates candidates(n_neighbors);
+		tree.search(vec,candidates);
+		std::vector<NearestCandidates::Candidate> nearest = candidates.sorted();
+
+		const IndexType k = nearest.size();
+		indices.resize(k);
+		p.resize(k);
+		DenseVector distances(k);
+		for (IndexType j=0; j<k; ++j)
+		{
+			indices[j] = nearest[j].second;
+			distances(j) = nearest[j].first;
+		}
+
+		ScalarType beta = 1.0;
+		ScalarType min_beta = -DBL_MAX;
+		ScalarType max_beta = DBL_MAX;
+		const ScalarType tol = 1e-5;
+		ScalarType sum_p = DBL_MIN;
+		for (IndexType iter=0; iter<200; ++iter)
+		{
+			// shifting distances by the smallest one doesn't change normalized affinities
+			p = (-beta*(distances.array() - distances(0))).exp();
+			sum_p = DBL_MIN + p.sum();
+			ScalarType H = beta*(distances.array() - distances(0)).matrix().dot(p)/sum_p + log(sum_p);
+			ScalarType H_diff = H - log(perplexity);
+			if (std::abs(H_diff) < tol)
+				break;
+
+			if (H_diff > 0)
+			{
+				min_beta = beta;
+				beta = (max_beta == DBL_MAX) ? beta*2.0 : (beta + max_beta)/2.0;
+			}
+			else
+			{
+				max_beta = beta;
+				beta = (min_beta == -DBL_MAX) ? beta/2.0 : (beta + min_beta)/2.0;
+			}
+		}
+		p /= sum_p;
+	}
+
+	//! Places the normalized vector into the embedding
+	DenseVector place(const DenseVector& vec) const
+	{
+		std::vector<IndexType> indices;
+		DenseVector p;
+		affinities(vec,indices,p);
+
+		const IndexType n_vectors = embedding.cols();
+		const IndexType dimension = embedding.rows();
+
+		DenseVector y = DenseVector::Zero(dimension);
+		for (IndexType j=0; j<static_cast<IndexType>(indices.size()); ++j)
+			y += p(j)*embedding.col(indices[j]);
+
+		// gradient is scaled just like the gradient of a single
+		// vector in t-SNE so the same learning rate is used
+		const ScalarType eta = 200.0;
+		ScalarType momentum = 0.5;
+		DenseVector update = DenseVector::Zero(dimension);
+		DenseVector gains = DenseVector::Ones(dimension);
+		DenseVector gradient(dimension);
+		DenseVector attraction(dimension);
+		DenseVector repulsion(dimension);
+		for (IndexType iter=0; iter<n_iterations; ++iter)
+		{
+			attraction.setZero();
+			for (IndexType j=0; j<static_cast<IndexType>(indices.size()); ++j)
+			{
+				DenseVector difference = y - embedding.col(indices[j]);
+				attraction += (p(j)/(1.0 + difference.squaredNorm()))*difference;
+			}
+			repulsion.setZero();
+			ScalarType sum_q = DBL_MIN;
+			for (IndexType j=0; j<n_vectors; ++j)
+			{
+				DenseVector difference = y - embedding.col(j);
+				ScalarType q = 1.0/(1.0 + difference.squaredNorm());
+				sum_q += q;
+				repulsion += (q*q)*difference;
+			}
+			gradient = (4.0/n_vectors)*(attraction - repulsion/sum_q);
+
+			for (IndexType d=0; d<dimension; ++d)
+			{
+				bool same_sign = (gradient(d) > 0.0) == (update(d) > 0.0);
+				gains(d) = same_sign ? std::max(gains(d)*0.8,0.01) : gains(d) + 0.2;
+			}
+			update = momentum*update - eta*gains.cwiseProduct(gradient);
+			y += update;
+
+			if (iter == n_iterations/4)
+				momentum = 0.8;
+		}
+		return y;
+	}
+};
+
+}
+}
+
+#endif
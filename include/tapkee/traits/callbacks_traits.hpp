@@ -30,6 +30,27 @@ namespace tapkee
 		static const bool value = (sizeof(dummy<T>(0)) == sizeof(yes));
 	};
 
+	//! Checks if the callback provides the distance_bounded(a,b,bound)
+	//! method that may stop computing the distance once it exceeds
+	//! the bound, returning any value larger than the bound.
+	template <class T>
+	class has_bounded_distance
+	{
+		typedef char yes;
+		typedef long no;
+
+		struct Fallback { int distance_bounded; };
+		struct Derived : T, Fallback { };
+
+		template <typename U, U> struct Check;
+
+		template <typename C> static no bounded(Check<int Fallback::*, &C::distance_bounded>*);
+		template <typename C> static yes bounded(...);
+
+		public:
+		static const bool value = (sizeof(bounded<Derived>(0)) == sizeof(yes));
+	};
+
 }
 
 #endif
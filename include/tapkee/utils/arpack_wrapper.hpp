@@ -55,7 +55,7 @@ public:
 	* This is a column vector with entries of type #RealScalar.
 	* The length of the vector is the size of \p nbrEigenvalues.
 	*/
-	typedef typename Eigen::internal::plain_col_type<LMatrixType, RealScalar>::type RealVectorType;
+	typedef Matrix<RealScalar, Dynamic, 1> RealVectorType;
 
 	/** \brief Default constructor.
 	*
@@ -417,6 +417,11 @@ ArpackGeneralizedSelfAdjointEigenSolver<LMatrixType, RMatrixType, MatrixOperatio
 	//		(mode==1 || mode==2) ? B :
 	//                   (mode==3) ? A : LMatrixType());
 
+	typedef Eigen::Map< Matrix<Scalar, Dynamic, 1> > VectorMap;
+	// Workspace for B * in products, allocated once so that
+	// the reverse communication loop performs no allocations
+	Matrix<Scalar, Dynamic, 1> Bx(n);
+
 	do
 	{
 		//std::cout << "Entering main loop\n";
@@ -432,9 +437,9 @@ ArpackGeneralizedSelfAdjointEigenSolver<LMatrixType, RMatrixType, MatrixOperatio
 			{
 				Scalar *out2 = workd + ipntr[2] - 1;
 				if (isBempty || mode == 1)
-					Matrix<Scalar, Dynamic, 1>::Map(out2, n) = Matrix<Scalar, Dynamic, 1>::Map(in, n);
+					VectorMap(out2, n) = VectorMap(in, n);
 				else
-					Matrix<Scalar, Dynamic, 1>::Map(out2, n) = B * Matrix<Scalar, Dynamic, 1>::Map(in, n);
+					VectorMap(out2, n).noalias() = B * VectorMap(in, n);
 				in = workd + ipntr[2] - 1;
 			}
 
@@ -443,7 +448,7 @@ ArpackGeneralizedSelfAdjointEigenSolver<LMatrixType, RMatrixType, MatrixOperatio
 				if (isBempty)
 				{
 					// OP = A
-					Matrix<Scalar, Dynamic, 1>::Map(out, n) = op(Matrix<Scalar, Dynamic, 1>::Map(in, n));
+					op.apply(VectorMap(in, n), VectorMap(out, n));
 				}
 				else
 				{
@@ -454,18 +459,25 @@ ArpackGeneralizedSelfAdjointEigenSolver<LMatrixType, RMatrixType, MatrixOperatio
 			else if (mode == 2)
 			{
 				if (ido == 1)
-					Matrix<Scalar, Dynamic, 1>::Map(in, n) = op(Matrix<Scalar, Dynamic, 1>::Map(in, n));
+				{
+					// out is used as scratch to avoid aliasing of in
+					op.apply(VectorMap(in, n), VectorMap(out, n));
+					VectorMap(in, n) = VectorMap(out, n);
+				}
 				// OP = B^{-1} A
-				Matrix<Scalar, Dynamic, 1>::Map(out, n) = op(Matrix<Scalar, Dynamic, 1>::Map(in, n));
+				op.apply(VectorMap(in, n), VectorMap(out, n));
 			}
 			else if (mode == 3)
 			{
 				// OP = (A-\sigmaB)B (\sigma could be 0, and B could be I)
 				// The B * in is already computed and stored at in if ido == 1
 				if (ido == 1 || isBempty)
-					Matrix<Scalar, Dynamic, 1>::Map(out, n) = op(Matrix<Scalar, Dynamic, 1>::Map(in, n));
+					op.apply(VectorMap(in, n), VectorMap(out, n));
 				else
-					Matrix<Scalar, Dynamic, 1>::Map(out, n) = op(B * Matrix<Scalar, Dynamic, 1>::Map(in, n));
+				{
+					Bx.noalias() = B * VectorMap(in, n);
+					op.apply(Bx, VectorMap(out, n));
+				}
 			}
 		}
 		else if (ido == 2)
@@ -474,9 +486,9 @@ ArpackGeneralizedSelfAdjointEigenSolver<LMatrixType, RMatrixType, MatrixOperatio
 			Scalar *out = workd + ipntr[1] - 1;
 
 			if (isBempty || mode == 1)
-				Matrix<Scalar, Dynamic, 1>::Map(out, n) = Matrix<Scalar, Dynamic, 1>::Map(in, n);
+				VectorMap(out, n) = VectorMap(in, n);
 			else
-				Matrix<Scalar, Dynamic, 1>::Map(out, n) = B * Matrix<Scalar, Dynamic, 1>::Map(in, n);
+				VectorMap(out, n).noalias() = B * VectorMap(in, n);
 		}
 		//Scalar *out = workd + ipntr[1] - 1;
 		//std::cout << Matrix<Scalar, Dynamic, 1>::Map(out, n).transpose() << std::endl;
@@ -0,0 +1,214 @@
+/* This software is distributed under BSD 3-clause license (see LICENSE file).
+ *
+ * Copyright (c) 2012-2013 Sergey Lisitsyn
+ */
+
+#ifndef TAPKEE_COUNTERS_H_
+#define TAPKEE_COUNTERS_H_
+
+#include <string>
+#include <sstream>
+#include <vector>
+#include <cstring>
+
+#ifdef __linux__
+	#define TAPKEE_PERF_EVENTS_AVAILABLE
+	#include <linux/perf_event.h>
+	#include <sys/syscall.h>
+	#include <sys/types.h>
+	#include <dirent.h>
+	#include <unistd.h>
+	#include <cerrno>
+	#include <cstdlib>
+#endif
+
+namespace tapkee
+{
+namespace tapkee_internal
+{
+
+//! Performance counters of all threads of the process opened
+//! with perf_event_open. Counting starts on construction. Threads
+//! spawned by monitored threads later are counted too as counters
+//! are inherited. Counters that are not supported or not permitted
+//! (see perf_event_paranoid) are just not reported.
+class hardware_counters
+{
+public:
+	enum Counter
+	{
+		TaskClock,
+		Cycles,
+		Instructions,
+		CacheMisses,
+		BranchMisses,
+		N_COUNTERS
+	};
+
+	hardware_counters() : open_error()
+	{
+		open();
+	}
+	~hardware_counters()
+	{
+		close();
+	}
+
+	//! Reads the counter summed across threads, values of multiplexed
+	//! counters are scaled by the time they were running
+	//! @param counter counter to read
+	//! @param value read value
+	//! @return false if the counter is not available
+	bool read(Counter counter, double& value) const
+	{
+		const std::vector<int>& fds = descriptors[counter];
+		if (fds.empty())
+			return false;
+		value = 0.0;
+#ifdef TAPKEE_PERF_EVENTS_AVAILABLE
+		for (size_t i=0; i<fds.size(); ++i)
+		{
+			// value, time enabled and time running
+			unsigned long long data[3];
+			if (::read(fds[i],data,sizeof(data)) != static_cast<ssize_t>(sizeof(data)))
+				return false;
+			if (data[2] > 0)
+				value += double(data[0])*data[1]/data[2];
+		}
+#endif
+		return true;
+	}
+
+	//! @return why cycles can't be counted or empty string if they can
+	std::string hardware_error() const
+	{
+		return descriptors[Cycles].empty() ? open_error : std::string();
+	}
+
+	//! Describes values of available counters
+	//! @param seconds wall clock time of the stage
+	//! @return description or empty string if no counter is available
+	std::string summary(double seconds) const
+	{
+		std::ostringstream ss;
+		ss.precision(3);
+		double task_clock, cycles, instructions, cache_misses, branch_misses;
+		const char* separator = "";
+		if (read(TaskClock,task_clock))
+		{
+			ss << separator << task_clock*1e-9 << " s CPU time";
+			if (seconds > 0.0)
+				ss << " (" << task_clock*1e-9/seconds << " threads busy)";
+			separator = ", ";
+		}
+		if (read(Cycles,cycles))
+		{
+			ss << separator << cycles << " cycles";
+			separator = ", ";
+		}
+		if (read(Instructions,instructions))
+		{
+			ss << separator << instructions << " instructions";
+			if (read(Cycles,cycles) && cycles > 0.0)
+				ss << " (" << instructions/cycles << " IPC)";
+			separator = ", ";
+		}
+		if (read(CacheMisses,cache_misses))
+		{
+			// each miss of the last level cache transfers a line from memory
+			ss << separator << cache_misses << " LLC misses";
+			if (seconds > 0.0)
+				ss << " (~" << cache_misses*cache_line_size/seconds*1e-9 << " GB/s memory traffic)";
+			separator = ", ";
+		}
+		if (read(BranchMisses,branch_misses))
+		{
+			ss << separator << branch_misses << " branch misses";
+			separator = ", ";
+		}
+		return ss.str();
+	}
+
+private:
+	hardware_counters(const hardware_counters&);
+	hardware_counters& operator=(const hardware_counters&);
+
+	static const int cache_line_size = 64;
+
+	void open()
+	{
+#ifdef TAPKEE_PERF_EVENTS_AVAILABLE
+		static const unsigned int types[N_COUNTERS] =
+			{ PERF_TYPE_SOFTWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+			  PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE };
+		static const unsigned long long configs[N_COUNTERS] =
+			{ PERF_COUNT_SW_TASK_CLOCK, PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+			  PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES };
+
+		std::vector<pid_t> threads;
+		DIR* tasks = opendir("/proc/self/task");
+		if (tasks)
+		{
+			while (dirent* entry = readdir(tasks))
+			{
+				if (entry->d_name[0] != '.')
+					threads.push_back(atoi(entry->d_name));
+			}
+			closedir(tasks);
+		}
+		else
+			threads.push_back(0);
+
+		for (int c=0; c<N_COUNTERS; ++c)
+		{
+			perf_event_attr attributes;
+			memset(&attributes,0,sizeof(attributes));
+			attributes.size = sizeof(attributes);
+			attributes.type = types[c];
+			attributes.config = configs[c];
+			attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+			attributes.inherit = 1;
+			attributes.exclude_kernel = 1;
+			attributes.exclude_hv = 1;
+			for (size_t t=0; t<threads.size(); ++t)
+			{
+				int fd = syscall(__NR_perf_event_open,&attributes,threads[t],-1,-1,0);
+				// threads could finish meanwhile, other failures disable the counter
+				if (fd < 0 && errno == ESRCH)
+					continue;
+				if (fd < 0)
+				{
+					if (open_error.empty())
+						open_error = strerror(errno);
+					close(c);
+					break;
+				}
+				descriptors[c].push_back(fd);
+			}
+		}
+#endif
+	}
+
+	void close(int counter)
+	{
+#ifdef TAPKEE_PERF_EVENTS_AVAILABLE
+		for (size_t i=0; i<descriptors[counter].size(); ++i)
+			::close(descriptors[counter][i]);
+#endif
+		descriptors[counter].clear();
+	}
+
+	void close()
+	{
+		for (int c=0; c<N_COUNTERS; ++c)
+			close(c);
+	}
+
+	std::vector<int> descriptors[N_COUNTERS];
+	std::string open_error;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,70 @@
+/* This software is distributed under BSD 3-clause license (see LICENSE file).
+ *
+ * Copyright (c) 2012-2013 Sergey Lisitsyn
+ */
+
+#ifndef TAPKEE_DISTANCE_H_
+#define TAPKEE_DISTANCE_H_
+
+/* Tapkee includes */
+#include <tapkee/defines.hpp>
+/* End of Tapkee includes */
+
+#include <cmath>
+
+namespace tapkee
+{
+namespace tapkee_internal
+{
+
+//! Returns squared Euclidean distance between two vectors or
+//! a partial sum larger than the bound once it is exceeded.
+//!
+//! Coordinates are processed in fixed-size blocks (vectorized
+//! by Eigen) and the bound is checked after each block so
+//! far away vectors are usually rejected after a fraction of
+//! their dimensions.
+//!
+//! @param a first vector
+//! @param b second vector
+//! @param squared_bound squared distance to abandon at
+//!
+template <class VectorTypeA, class VectorTypeB>
+inline ScalarType bounded_squared_euclidean_distance(const Eigen::MatrixBase<VectorTypeA>& a,
+                                                     const Eigen::MatrixBase<VectorTypeB>& b,
+                                                     ScalarType squared_bound)
+{
+	const IndexType block = 16;
+	const IndexType n = a.size();
+	ScalarType sum = 0.0;
+	IndexType i = 0;
+	for (; i+block<=n; i+=block)
+	{
+		sum += (a.template segment<block>(i) - b.template segment<block>(i)).squaredNorm();
+		if (sum > squared_bound)
+			return sum;
+	}
+	if (i < n)
+		sum += (a.tail(n-i) - b.tail(n-i)).squaredNorm();
+	return sum;
+}
+
+//! Returns Euclidean distance between two vectors or any
+//! value larger than the bound if the distance exceeds it.
+//!
+//! @param a first vector
+//! @param b second vector
+//! @param bound distance to abandon at
+//!
+template <class VectorTypeA, class VectorTypeB>
+inline ScalarType bounded_euclidean_distance(const Eigen::MatrixBase<VectorTypeA>& a,
+                                             const Eigen::MatrixBase<VectorTypeB>& b,
+                                             ScalarType bound)
+{
+	return std::sqrt(bounded_squared_euclidean_distance(a,b,bound*bound));
+}
+
+}
+}
+
+#endif
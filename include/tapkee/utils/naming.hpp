@@ -25,6 +25,7 @@ std::string get_method_name(DimensionReductionMethod m)
 		case LinearLocalTangentSpaceAlignment: return "Linear Local Tangent Space Alignment";
 		case HessianLocallyLinearEmbedding: return "Hessian Locally Linear Embedding";
 		case LaplacianEigenmaps: return "Laplacian Eigenmaps";
+		case LandmarkLaplacianEigenmaps: return "Landmark Laplacian Eigenmaps";
 		case LocalityPreservingProjections: return "Locality Preserving Embedding";
 		case PCA: return "Principal Component Analysis";
 		case KernelPCA: return "Kernel Principal Component Analysis";
@@ -50,5 +51,11 @@ std::string get_eigen_method_name(const EigenMethod& m)
 	return m.name();
 }
 
+/** Returns the name of the provided sampling method */
+std::string get_sampling_method_name(const SamplingMethod& m)
+{
+	return m.name();
+}
+
 }
 #endif
@@ -10,6 +10,12 @@
 #include <tapkee/defines.hpp>
  /* End of Tapkee includes */
 
+#include <vector>
+#include <algorithm>
+#ifdef _OPENMP
+	#include <omp.h>
+#endif
+
 namespace tapkee 
 {
 namespace tapkee_internal
@@ -30,6 +36,132 @@ SparseMatrix sparse_matrix_from_triplets(const SparseTriplets& sparse_triplets,
 	return matrix;
 }
 
+//! Symmetric sparse matrix that stores only the upper triangle in the
+//! compressed sparse row format. Rows are split into contiguous chunks 
+//! with (roughly) equal number of non-zeros, one per thread, so products
+//! with blocks of vectors are computed in parallel.
+//!
+//! Each stored entry \f$ a_{ij}, j > i \f$ contributes to both rows 
+//! \f$ i \f$ and \f$ j \f$ of the product. Contributions to rows owned by 
+//! the chunk are written directly while contributions to rows of subsequent 
+//! chunks are accumulated in per-chunk buffers and reduced afterwards.
+//!
+struct SymmetricSparseMatrix
+{
+	//! Constructs the matrix from the symmetric sparse matrix 
+	//! reading only one of its triangles
+	//!
+	//! @param matrix symmetric sparse matrix
+	//!
+	SymmetricSparseMatrix(const SparseMatrix& matrix) :
+		n(matrix.rows()), offsets(matrix.rows()+1,0), indices(), values(), chunks(), buffers()
+	{
+		indices.reserve(matrix.nonZeros()/2 + n);
+		values.reserve(matrix.nonZeros()/2 + n);
+		// the matrix is symmetric so row i of the upper triangle
+		// is the lower part of column i
+		for (IndexType i=0; i<n; ++i)
+		{
+			for (SparseMatrix::InnerIterator it(matrix,i); it; ++it)
+			{
+				if (it.row() >= i)
+				{
+					indices.push_back(it.row());
+					values.push_back(it.value());
+				}
+			}
+			offsets[i+1] = indices.size();
+		}
+
+		IndexType n_chunks = 1;
+#ifdef _OPENMP
+		n_chunks = std::max(1,std::min(omp_get_max_threads(),n));
+#endif
+		chunks.push_back(0);
+		for (IndexType c=1; c<n_chunks; ++c)
+		{
+			IndexType target = (offsets[n]*c)/n_chunks;
+			IndexType row = std::lower_bound(offsets.begin(),offsets.end(),target) - offsets.begin();
+			chunks.push_back(std::max(chunks.back(),std::min(row,n)));
+		}
+		chunks.push_back(n);
+		buffers.resize(n_chunks);
+	}
+
+	inline IndexType rows() const 
+	{
+		return n;
+	}
+	inline IndexType cols() const 
+	{
+		return n;
+	}
+	inline IndexType nonZeros() const
+	{
+		return offsets[n];
+	}
+
+	//! Computes product of the matrix and the provided block of vectors
+	//!
+	//! @param rhs right-hand side block
+	//! @param result storage for the product
+	//!
+	template <class InputType, class OutputType>
+	void multiply(const Eigen::MatrixBase<InputType>& rhs, const Eigen::MatrixBase<OutputType>& result)
+	{
+		OutputType& y = result.const_cast_derived();
+		const IndexType k = rhs.cols();
+		const IndexType n_chunks = chunks.size()-1;
+		y.setZero();
+
+#pragma omp parallel for schedule(static,1)
+		for (IndexType c=0; c<n_chunks; ++c)
+		{
+			const IndexType begin = chunks[c];
+			const IndexType end = chunks[c+1];
+			DenseMatrix& buffer = buffers[c];
+			buffer.setZero(n-end,k);
+			for (IndexType i=begin; i<end; ++i)
+			{
+				for (IndexType p=offsets[i]; p<offsets[i+1]; ++p)
+				{
+					const IndexType j = indices[p];
+					const ScalarType a = values[p];
+					y.row(i) += a*rhs.row(j);
+					if (j == i)
+						continue;
+					if (j < end)
+						y.row(j) += a*rhs.row(i);
+					else
+						buffer.row(j-end) += a*rhs.row(i);
+				}
+			}
+		}
+
+		if (n_chunks > 1)
+		{
+#pragma omp parallel for
+			for (IndexType i=0; i<n; ++i)
+			{
+				for (IndexType c=0; c<n_chunks && chunks[c+1]<=i; ++c)
+					y.row(i) += buffers[c].row(i-chunks[c+1]);
+			}
+		}
+	}
+
+	IndexType n;
+	//! offsets of rows in indices and values
+	std::vector<IndexType> offsets;
+	//! column indices of stored entries
+	std::vector<IndexType> indices;
+	//! values of stored entries
+	std::vector<ScalarType> values;
+	//! first rows of chunks processed by threads
+	std::vector<IndexType> chunks;
+	//! per-chunk storage of contributions to rows of subsequent chunks
+	std::vector<DenseMatrix> buffers;
+};
+
 }
 }
 
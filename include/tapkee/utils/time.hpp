@@ -8,6 +8,9 @@
 
 /* Tapkee includes */
 #include <tapkee/utils/logging.hpp>
+#ifdef TAPKEE_WITH_PERF_COUNTERS
+	#include <tapkee/utils/counters.hpp>
+#endif
 /* End of Tapkee includes */
 
 #include <ctime>
@@ -28,19 +31,58 @@ namespace tapkee_internal
 	#define CLOCK_DIVISOR CLOCKS_PER_SEC
 #endif
 
+//! Logs time taken by the operation when the context is
+//! destroyed. If TAPKEE_WITH_PERF_COUNTERS is defined and
+//! benchmark messages are enabled performance counters of the
+//! operation are logged as well.
 struct timed_context
 {
 	CLOCK_TYPE start_clock;
 	std::string operation_name;
+#ifdef TAPKEE_WITH_PERF_COUNTERS
+	hardware_counters* counters;
+#endif
 	timed_context(const std::string& name) : start_clock(CLOCK_GET), operation_name(name)
+#ifdef TAPKEE_WITH_PERF_COUNTERS
+		, counters(LoggingSingleton::instance().is_benchmark_enabled() ? new hardware_counters : NULL)
+#endif
 	{
 	}
 	~timed_context()
 	{
-		std::string message = formatting::format("{} took {} seconds.", operation_name,
-				double(CLOCK_GET-start_clock)/CLOCK_DIVISOR);
+		double seconds = double(CLOCK_GET-start_clock)/CLOCK_DIVISOR;
+		std::string message = formatting::format("{} took {} seconds.", operation_name, seconds);
 		LoggingSingleton::instance().message_benchmark(message);
+#ifdef TAPKEE_WITH_PERF_COUNTERS
+		if (counters)
+		{
+			report_counters(seconds);
+			delete counters;
+		}
+#endif
 	}
+#ifdef TAPKEE_WITH_PERF_COUNTERS
+private:
+	timed_context(const timed_context&);
+	timed_context& operator=(const timed_context&);
+
+	void report_counters(double seconds) const
+	{
+		// the reason counters are not available is logged only once
+		static bool unavailability_reported = false;
+		std::string error = counters->hardware_error();
+		if (!error.empty() && !unavailability_reported)
+		{
+			LoggingSingleton::instance().message_benchmark(
+				formatting::format("Hardware counters are not available: {}", error));
+			unavailability_reported = true;
+		}
+		std::string summary = counters->summary(seconds);
+		if (!summary.empty())
+			LoggingSingleton::instance().message_benchmark(
+				formatting::format("{} counters: {}.", operation_name, summary));
+	}
+#endif
 };
 }
 }
@@ -0,0 +1,345 @@
+/* This software is distributed under BSD 3-clause license (see LICENSE file).
+ *
+ * Copyright (c) 2012-2013 Sergey Lisitsyn, Fernando Iglesias
+ */
+
+#ifndef TAPKEE_APP_COMPRESSED_H_
+#define TAPKEE_APP_COMPRESSED_H_
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <deque>
+#include <istream>
+#include <fstream>
+#include <streambuf>
+#include <stdexcept>
+
+#ifdef TAPKEE_WITH_ZLIB
+	#include <zlib.h>
+#endif
+#ifdef TAPKEE_WITH_ZSTD
+	#include <zstd.h>
+#endif
+
+#if __cplusplus >= 201103L
+	#define TAPKEE_APP_WITH_THREADS
+	#include <thread>
+	#include <mutex>
+	#include <condition_variable>
+#endif
+
+enum Compression
+{
+	NoCompression,
+	GzipCompression,
+	ZstdCompression
+};
+
+//! Detects compression of the file by its magic number
+inline Compression detect_compression(const std::string& filename)
+{
+	unsigned char magic[4] = {0,0,0,0};
+	FILE* file = fopen(filename.c_str(),"rb");
+	if (!file)
+		return NoCompression;
+	size_t n_read = fread(magic,1,4,file);
+	fclose(file);
+
+	if (n_read >= 2 && magic[0]==0x1f && magic[1]==0x8b)
+		return GzipCompression;
+	if (n_read == 4 && magic[0]==0x28 && magic[1]==0xb5 && magic[2]==0x2f && magic[3]==0xfd)
+		return ZstdCompression;
+	return NoCompression;
+}
+
+//! Decoder of a compressed file producing blocks of decompressed data
+class BlockDecoder
+{
+public:
+	virtual ~BlockDecoder()
+	{
+	}
+	//! Decodes the next block, throws std::runtime_error if data is corrupted
+	//! @param block decompressed data
+	//! @return false if there is no more data
+	virtual bool decode(std::string& block) = 0;
+};
+
+#ifdef TAPKEE_WITH_ZLIB
+//! Decoder of gzip compressed files (including concatenated ones)
+class GzipDecoder : public BlockDecoder
+{
+public:
+	GzipDecoder(const std::string& filename) : file(gzopen(filename.c_str(),"rb"))
+	{
+		if (!file)
+			throw std::runtime_error("Can't open input file " + filename);
+		gzbuffer(file,block_size);
+	}
+	virtual ~GzipDecoder()
+	{
+		gzclose(file);
+	}
+	virtual bool decode(std::string& block)
+	{
+		block.resize(block_size);
+		int n_read = gzread(file,&block[0],block_size);
+		int error = Z_OK;
+		const char* message = gzerror(file,&error);
+		// truncated files are reported as Z_BUF_ERROR without failing the read
+		if (n_read < 0 || (n_read == 0 && error == Z_BUF_ERROR))
+			throw std::runtime_error(std::string("Can't decompress input file: ") + message);
+		block.resize(n_read);
+		return n_read > 0;
+	}
+private:
+	GzipDecoder(const GzipDecoder&);
+	GzipDecoder& operator=(const GzipDecoder&);
+
+	static const unsigned int block_size = 1 << 17;
+	gzFile file;
+};
+#endif
+
+#ifdef TAPKEE_WITH_ZSTD
+//! Decoder of zstd compressed files (including multiple frames)
+class ZstdDecoder : public BlockDecoder
+{
+public:
+	ZstdDecoder(const std::string& filename) :
+		file(fopen(filename.c_str(),"rb")), stream(NULL),
+		input_buffer(ZSTD_DStreamInSize()), input(), pending(false), in_frame(false)
+	{
+		if (!file)
+			throw std::runtime_error("Can't open input file " + filename);
+		stream = ZSTD_createDStream();
+		ZSTD_initDStream(stream);
+		input.src = &input_buffer[0];
+		input.size = 0;
+		input.pos = 0;
+	}
+	virtual ~ZstdDecoder()
+	{
+		ZSTD_freeDStream(stream);
+		fclose(file);
+	}
+	virtual bool decode(std::string& block)
+	{
+		block.resize(ZSTD_DStreamOutSize());
+		ZSTD_outBuffer output;
+		output.dst = &block[0];
+		output.size = block.size();
+		output.pos = 0;
+		while (output.pos == 0)
+		{
+			// the decoder could hold data that didn't fit the previous block
+			if (input.pos == input.size && !pending)
+			{
+				size_t n_read = fread(&input_buffer[0],1,input_buffer.size(),file);
+				if (n_read == 0)
+				{
+					if (in_frame)
+						throw std::runtime_error("Can't decompress input file: it is truncated");
+					block.clear();
+					return false;
+				}
+				input.size = n_read;
+				input.pos = 0;
+			}
+			size_t result = ZSTD_decompressStream(stream,&output,&input);
+			if (ZSTD_isError(result))
+				throw std::runtime_error(std::string("Can't decompress input file: ") + ZSTD_getErrorName(result));
+			pending = (output.pos == output.size);
+			// zero is returned once a frame is completely decoded
+			in_frame = (result != 0);
+		}
+		block.resize(output.pos);
+		return true;
+	}
+private:
+	ZstdDecoder(const ZstdDecoder&);
+	ZstdDecoder& operator=(const ZstdDecoder&);
+
+	FILE* file;
+	ZSTD_DStream* stream;
+	std::vector<char> input_buffer;
+	ZSTD_inBuffer input;
+	bool pending;
+	bool in_frame;
+};
+#endif
+
+//! Stream buffer over decompressed data. If threads are available
+//! the decoder runs in its own thread and passes decompressed blocks
+//! through a bounded queue so decompression overlaps parsing done
+//! by the reader and reading takes as long as the slower of them.
+class decompressing_streambuf : public std::streambuf
+{
+public:
+	//! @param block_decoder decoder, owned by the buffer
+	decompressing_streambuf(BlockDecoder* block_decoder) :
+		decoder(block_decoder), current()
+#ifdef TAPKEE_APP_WITH_THREADS
+		, blocks(), finished(false), cancelled(false), error(), mutex(), changed(), decoding()
+#endif
+	{
+#ifdef TAPKEE_APP_WITH_THREADS
+		decoding = std::thread(&decompressing_streambuf::produce,this);
+#endif
+	}
+	virtual ~decompressing_streambuf()
+	{
+#ifdef TAPKEE_APP_WITH_THREADS
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			cancelled = true;
+		}
+		changed.notify_all();
+		decoding.join();
+#endif
+		delete decoder;
+	}
+
+protected:
+	virtual int_type underflow()
+	{
+		if (gptr() < egptr())
+			return traits_type::to_int_type(*gptr());
+		if (!next_block())
+			return traits_type::eof();
+		setg(&current[0],&current[0],&current[0]+current.size());
+		return traits_type::to_int_type(*gptr());
+	}
+
+private:
+	decompressing_streambuf(const decompressing_streambuf&);
+	decompressing_streambuf& operator=(const decompressing_streambuf&);
+
+#ifdef TAPKEE_APP_WITH_THREADS
+	static const size_t max_blocks = 8;
+
+	void produce()
+	{
+		try
+		{
+			bool more = true;
+			while (more)
+			{
+				std::string block;
+				more = decoder->decode(block);
+				std::unique_lock<std::mutex> lock(mutex);
+				while (blocks.size() >= max_blocks && !cancelled)
+					changed.wait(lock);
+				if (cancelled)
+					return;
+				if (more)
+				{
+					blocks.push_back(std::string());
+					blocks.back().swap(block);
+				}
+				else
+					finished = true;
+				changed.notify_all();
+			}
+		}
+		catch (const std::exception& exc)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			error = exc.what();
+			finished = true;
+			changed.notify_all();
+		}
+	}
+
+	bool next_block()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		while (blocks.empty() && !finished)
+			changed.wait(lock);
+		if (!blocks.empty())
+		{
+			current.swap(blocks.front());
+			blocks.pop_front();
+			changed.notify_all();
+			return true;
+		}
+		if (!error.empty())
+			throw std::runtime_error(error);
+		return false;
+	}
+#else
+	bool next_block()
+	{
+		while (decoder->decode(current))
+		{
+			if (!current.empty())
+				return true;
+		}
+		return false;
+	}
+#endif
+
+	BlockDecoder* decoder;
+	//! block being read
+	std::string current;
+#ifdef TAPKEE_APP_WITH_THREADS
+	//! decoded blocks not read yet
+	std::deque<std::string> blocks;
+	bool finished;
+	bool cancelled;
+	std::string error;
+	std::mutex mutex;
+	std::condition_variable changed;
+	std::thread decoding;
+#endif
+};
+
+//! Input file stream that transparently decompresses gzip and zstd
+//! compressed files detected by their magic numbers. Errors of reading
+//! (including corrupted compressed data) are thrown as exceptions.
+class input_file_stream : public std::istream
+{
+public:
+	input_file_stream(const std::string& filename) : std::istream(NULL), file(), decompressing(NULL)
+	{
+		switch (detect_compression(filename))
+		{
+			case GzipCompression:
+#ifdef TAPKEE_WITH_ZLIB
+				decompressing = new decompressing_streambuf(new GzipDecoder(filename));
+				break;
+#else
+				throw std::runtime_error(filename + " is gzip compressed but zlib support is not available");
+#endif
+			case ZstdCompression:
+#ifdef TAPKEE_WITH_ZSTD
+				decompressing = new decompressing_streambuf(new ZstdDecoder(filename));
+				break;
+#else
+				throw std::runtime_error(filename + " is zstd compressed but zstd support is not available");
+#endif
+			case NoCompression:
+				if (!file.open(filename.c_str(),std::ios::in))
+					throw std::runtime_error("Can't open input file " + filename);
+				break;
+		}
+		if (decompressing)
+			rdbuf(decompressing);
+		else
+			rdbuf(&file);
+		exceptions(std::ios::badbit);
+	}
+	virtual ~input_file_stream()
+	{
+		delete decompressing;
+	}
+private:
+	input_file_stream(const input_file_stream&);
+	input_file_stream& operator=(const input_file_stream&);
+
+	std::filebuf file;
+	decompressing_streambuf* decompressing;
+};
+
+#endif
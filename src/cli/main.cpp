@@ -13,8 +13,17 @@
 #include <string>
 #include <vector>
 #include <iterator>
+#include <map>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#if defined(__unix__) || defined(__APPLE__)
+	#include <unistd.h>
+#endif
 #include "ezoptionparser.hpp"
 #include "util.hpp"
+#include "server.hpp"
+#include "compressed.hpp"
 
 #ifdef GIT_INFO
 	#define TAPKEE_CURRENT_GIT_INFO GIT_INFO
@@ -26,26 +35,6 @@ using namespace ez;
 using namespace Eigen;
 using namespace std;
 
-bool cancel()
-{
-	return false;
-}
-
-int run(int argc, const char** argv)
-{
-	srand(static_cast<unsigned int>(time(NULL)));
-
-	ezOptionParser opt;
-	opt.footer = "Copyright (C) 2012-2013 Sergey Lisitsyn <lisitsyn.s.o@gmail.com>, Fernando Iglesias <fernando.iglesiasg@gmail.com>\n"
-	             "This is free software: you are free to change and redistribute it.\n"
-	             "There is NO WARRANTY, to the extent permitted by law.";
-	opt.overview = "Tapkee library application for reduction dimensions of dense matrices.\n"
-	               "Git " TAPKEE_CURRENT_GIT_INFO;
-	opt.example = "Run locally linear embedding with k=10 with arpack "
-                  "eigensolver on data from input.dat saving embedding to output.dat \n\n"
-	              "tapkee -i input.dat -o output.dat --method lle --eigen-method arpack -k 10\n\n";
-	opt.syntax = "tapkee [options]\n";
-
 #if defined(_WIN32) || defined(_WIN64)
 	#define OPT_PREFIX "/"
 	#define OPT_LONG_PREFIX "/"
@@ -54,13 +43,27 @@ int run(int argc, const char** argv)
 	#define OPT_LONG_PREFIX "--"
 #endif
 
+
+bool cancel()
+{
+	return false;
+}
+
+void add_options(ezOptionParser& opt)
+{
 #define INPUT_FILE_KEYWORD "input-file"
-	opt.add("",0,1,0,"Input file",
+	opt.add("",0,1,0,"Input file, gzip and zstd compressed files are decompressed on the fly",
 			OPT_PREFIX "i",
 		    OPT_LONG_PREFIX INPUT_FILE_KEYWORD);
 #define TRANSPOSE_INPUT_KEYWORD "transpose-input"
 	opt.add("",0,0,0,"Transpose input file if set",
 		OPT_LONG_PREFIX TRANSPOSE_INPUT_KEYWORD);
+#define INPUT_FORMAT_KEYWORD "input-format"
+	opt.add("dense",0,1,0,"Format of input file (default is 'dense'). One of the following: \n"
+		"dense (whitespace separated values), libsvm (a feature vector per line), \n"
+		"matrix-market (coordinate format, feature vectors in columns unless transposed). \n"
+		"Sparse formats are embedded without making the data dense",
+		OPT_LONG_PREFIX INPUT_FORMAT_KEYWORD);
 #define TRANSPOSE_OUTPUT_KEYWORD "transpose-output"
 	opt.add("",0,0,0,"Transpose output file if set",
 		OPT_LONG_PREFIX TRANSPOSE_OUTPUT_KEYWORD);
@@ -94,7 +97,8 @@ int run(int argc, const char** argv)
 			"Dimension reduction method (default locally_linear_embedding). \n One of the following: \n"
 			"locally_linear_embedding (lle), neighborhood_preserving_embedding (npe), \n"
 			"local_tangent_space_alignment (ltsa), linear_local_tangent_space_alignment (lltsa), \n"
-			"hessian_locally_linear_embedding (hlle), laplacian_eigenmaps (la), locality_preserving_projections (lpp), \n"
+			"hessian_locally_linear_embedding (hlle), laplacian_eigenmaps (la), \n"
+			"landmark_laplacian_eigenmaps (l-la), locality_preserving_projections (lpp), \n"
 			"diffusion_map (dm), isomap, landmark_isomap (l-isomap), multidimensional_scaling (mds), \n"
 			"landmark_multidimensional_scaling (l-mds), stochastic_proximity_embedding (spe), \n"
 			"kernel_pca (kpca), pca, random_projection (ra), factor_analysis (fa), \n"
@@ -109,7 +113,7 @@ int run(int argc, const char** argv)
 			"brute",
 #endif
 			0,1,0,"Neighbors search method (default is 'covertree' if available, 'brute' otherwise). One of the following: "
-			"brute"
+			"brute,vptree,kdtree,balltree"
 #ifdef TAPKEE_USE_LGPL_COVERTREE
 			",covertree"
 #endif
@@ -127,7 +131,7 @@ int run(int argc, const char** argv)
 #ifdef TAPKEE_WITH_ARPACK	
 		"arpack, "
 #endif
-		"randomized, dense.",
+		"randomized, dense, lobpcg, chebyshev.",
 		OPT_PREFIX "em",
 		OPT_LONG_PREFIX EIGEN_METHOD_KEYWORD);
 #define COMPUTATION_STRATEGY_KEYWORD "computation-strategy"
@@ -155,6 +159,10 @@ int run(int argc, const char** argv)
 #define TIMESTEPS_KEYWORD "timesteps"
 	opt.add("1",0,1,0,"Number of timesteps for diffusion map (default 1)",
 		OPT_LONG_PREFIX TIMESTEPS_KEYWORD);
+#define NYSTROM_KEYWORD "nystrom"
+	opt.add("0",0,0,0,"Approximate diffusion map with kernel values to landmarks only, \n"
+		"see --landmark-ratio (default false)",
+		OPT_LONG_PREFIX NYSTROM_KEYWORD);
 #define SPE_LOCAL_KEYWORD "spe-local"
 	opt.add("0",0,0,0,"Local strategy in SPE (default global)",
 		OPT_LONG_PREFIX SPE_LOCAL_KEYWORD);
@@ -185,33 +193,38 @@ int run(int argc, const char** argv)
 #define MS_SQUISHING_RATE_KEYWORD "squishing-rate"
 	opt.add("0.99",0,1,0,"Squishing rate of the Manifold Sculpting algorithm (default 0.5)",
 		OPT_LONG_PREFIX MS_SQUISHING_RATE_KEYWORD);
+#define COLLAPSE_DUPLICATES_KEYWORD "collapse-duplicates"
+	opt.add("0",0,0,0,"Embed only distinct vectors and copy their embedding to duplicates (default false)",
+		OPT_LONG_PREFIX COLLAPSE_DUPLICATES_KEYWORD);
+#define SAMPLE_SIZE_KEYWORD "sample-size"
+	opt.add("0",0,1,0,"Embed only a sample of vectors with the method and project or \n"
+		"interpolate the rest of vectors (default 0, i.e. embed all vectors)",
+		OPT_LONG_PREFIX SAMPLE_SIZE_KEYWORD);
+#define SAMPLING_METHOD_KEYWORD "sampling-method"
+	opt.add("uniform",0,1,0,"Sampling method (default is 'uniform'). One of the following: "
+		"uniform, farthest.",
+		OPT_LONG_PREFIX SAMPLING_METHOD_KEYWORD);
+#define SERVE_KEYWORD "serve"
+	opt.add("",0,1,0,"Serve embedding requests over the Unix domain socket at the provided path \n"
+		"keeping loaded data, neighbors and projections in memory between requests. \n"
+		"Each request is a line, one of: 'load NAME FILE [--transpose-input]', \n"
+		"'embed NAME [OPTIONS]', 'project NAME FILE [--transpose-input]', 'unload NAME', \n"
+		"'list' or 'shutdown'. Options not set by a request are taken from the command line",
+		OPT_LONG_PREFIX SERVE_KEYWORD);
+#define SWEEP_KEYWORD "sweep"
+	opt.add("",0,1,0,"Run a parameter sweep: embed the data with each of configurations \n"
+		"listed in the file, one configuration of options per line (e.g. '-m isomap -k 15'), \n"
+		"options that are not set by a configuration are taken from the command line. \n"
+		"Embeddings are saved to <output-file>.<index> and timings to <output-file>.summary",
+		OPT_LONG_PREFIX SWEEP_KEYWORD);
+#define SWEEP_JOBS_KEYWORD "sweep-jobs"
+	opt.add("1",0,1,0,"Maximal number of sweep configurations to embed concurrently (default 1), \n"
+		"reduced if there is not enough memory",
+		OPT_LONG_PREFIX SWEEP_JOBS_KEYWORD);
+}
 
-	opt.parse(argc, argv);
-
-	if (opt.isSet(OPT_LONG_PREFIX HELP_KEYWORD))
-	{
-		string usage;
-		opt.getUsage(usage);
-		std::cout << usage << std::endl;
-		return 0;
-	}
-
-	if (opt.isSet(OPT_LONG_PREFIX VERBOSE_KEYWORD))
-	{
-		tapkee::LoggingSingleton::instance().enable_info();
-	}
-	if (opt.isSet(OPT_LONG_PREFIX DEBUG_KEYWORD))
-	{
-		tapkee::LoggingSingleton::instance().enable_debug();
-		tapkee::LoggingSingleton::instance().message_info("Debug messages enabled");
-	}
-
-	if (opt.isSet(OPT_LONG_PREFIX BENCHMARK_KEYWORD))
-	{
-		tapkee::LoggingSingleton::instance().enable_benchmark();
-		tapkee::LoggingSingleton::instance().message_info("Benchmarking enabled");
-	}
-	
+bool parameters_from_options(ezOptionParser& opt, tapkee::ParametersSet& parameters)
+{
 	tapkee::DimensionReductionMethod tapkee_method;
 	{
 		string method;
@@ -223,7 +236,7 @@ int run(int argc, const char** argv)
 		catch (const std::exception&)
 		{
 			tapkee::LoggingSingleton::instance().message_error(string("Unknown method ") + method);
-			return 0;
+			return false;
 		}
 	}
 	
@@ -238,7 +251,7 @@ int run(int argc, const char** argv)
 		catch (const std::exception&)
 		{
 			tapkee::LoggingSingleton::instance().message_error(string("Unknown neighbors method ") + method);
-			return 0;
+			return false;
 		}
 	}
 	tapkee::EigenMethod tapkee_eigen_method = tapkee::Dense;
@@ -252,7 +265,7 @@ int run(int argc, const char** argv)
 		catch (const std::exception&)
 		{
 			tapkee::LoggingSingleton::instance().message_error(string("Unknown eigendecomposition method ") + method);
-			return 0;
+			return false;
 		}
 	}
 	tapkee::ComputationStrategy tapkee_computation_strategy = tapkee::HomogeneousCPUStrategy;
@@ -266,7 +279,7 @@ int run(int argc, const char** argv)
 		catch (const std::exception&)
 		{
 			tapkee::LoggingSingleton::instance().message_error(string("Unknown computation strategy ") + method);
-			return 0;
+			return false;
 		}
 	}
 	int target_dim = 1;
@@ -276,7 +289,7 @@ int run(int argc, const char** argv)
 		{
 			tapkee::LoggingSingleton::instance().message_error("Negative target dimensionality is not possible in current circumstances. "
 			                                                   "Please visit other universe");
-			return 0;
+			return false;
 		}
 	}
 	int k = 1;
@@ -285,7 +298,7 @@ int run(int argc, const char** argv)
 		if (k < 3)
 		{
 			tapkee::LoggingSingleton::instance().message_error("The provided number of neighbors is too small, consider at least 3.");
-			return 0;
+			return false;
 		}
 	}
 	double width = 1.0;
@@ -294,7 +307,7 @@ int run(int argc, const char** argv)
 		if (width < 0.0) 
 		{
 			tapkee::LoggingSingleton::instance().message_error("Width of the gaussian kernel is negative.");
-			return 0;
+			return false;
 		}
 	}
 	int timesteps = 1;
@@ -303,7 +316,7 @@ int run(int argc, const char** argv)
 		if (timesteps < 0)
 		{
 			tapkee::LoggingSingleton::instance().message_error("Number of timesteps is negative.");
-			return 0;
+			return false;
 		}
 	}
 	double eigenshift = 1e-9;
@@ -349,53 +362,39 @@ int run(int argc, const char** argv)
 	{
 		opt.get(OPT_LONG_PREFIX MS_SQUISHING_RATE_KEYWORD)->getDouble(squishing);
 	}
-
-	// Load data
-	string input_filename;
-	string output_filename;
-	if (!opt.isSet(OPT_LONG_PREFIX INPUT_FILE_KEYWORD))
+	bool nystrom = false;
 	{
-		tapkee::LoggingSingleton::instance().message_error("No input file specified. Please use " OPT_PREFIX "h flag if stucked");
-		return 0;
+		nystrom = opt.isSet(OPT_LONG_PREFIX NYSTROM_KEYWORD);
 	}
-	else
-		opt.get(OPT_LONG_PREFIX INPUT_FILE_KEYWORD)->getString(input_filename);
-
-	if (!opt.isSet(OPT_LONG_PREFIX OUTPUT_FILE_KEYWORD))
+	bool collapse = false;
 	{
-		tapkee::LoggingSingleton::instance().message_warning("No output file specified, using /dev/tty");
-		output_filename = "/dev/tty";
+		collapse = opt.isSet(OPT_LONG_PREFIX COLLAPSE_DUPLICATES_KEYWORD);
 	}
-	else
-		opt.get(OPT_LONG_PREFIX OUTPUT_FILE_KEYWORD)->getString(output_filename);
-
-	bool output_projection = false;
-	std::string output_matrix_filename = "/dev/null";
-	std::string output_mean_filename = "/dev/null";
-	if (opt.isSet(OPT_LONG_PREFIX OUTPUT_PROJECTION_MATRIX_FILE_KEYWORD) &&
-		opt.isSet(OPT_LONG_PREFIX OUTPUT_PROJECTION_MEAN_FILE_KEYWORD))
+	int sample_size = 0;
 	{
-		output_projection = true;
-		opt.get(OPT_LONG_PREFIX OUTPUT_PROJECTION_MATRIX_FILE_KEYWORD)->getString(output_matrix_filename);
-		opt.get(OPT_LONG_PREFIX OUTPUT_PROJECTION_MEAN_FILE_KEYWORD)->getString(output_mean_filename);
+		opt.get(OPT_LONG_PREFIX SAMPLE_SIZE_KEYWORD)->getInt(sample_size);
+		if (sample_size < 0)
+		{
+			tapkee::LoggingSingleton::instance().message_error("Sample size is negative.");
+			return false;
+		}
+	}
+	tapkee::SamplingMethod tapkee_sampling_method = tapkee::UniformSampling;
+	{
+		string method;
+		opt.get(OPT_LONG_PREFIX SAMPLING_METHOD_KEYWORD)->getString(method);
+		try
+		{
+			tapkee_sampling_method = parse_sampling_method(method.c_str());
+		}
+		catch (const std::exception&)
+		{
+			tapkee::LoggingSingleton::instance().message_error(string("Unknown sampling method ") + method);
+			return false;
+		}
 	}
 
-	ifstream ifs(input_filename.c_str());
-	ofstream ofs(output_filename.c_str());
-	ofstream ofs_matrix(output_matrix_filename.c_str());
-	ofstream ofs_mean(output_matrix_filename.c_str());
-
-	tapkee::DenseMatrix input_data = read_data(ifs);
-	if (opt.isSet(OPT_LONG_PREFIX TRANSPOSE_INPUT_KEYWORD))
-		input_data.transposeInPlace();
-	
-	std::stringstream ss;
-	ss << "Data contains " << input_data.cols() << " feature vectors with dimension of " << input_data.rows();
-	tapkee::LoggingSingleton::instance().message_info(ss.str());
-	
-	tapkee::TapkeeOutput output;
-	
-	tapkee::ParametersSet parameters = 
+	parameters = 
 			tapkee::kwargs[
 			 tapkee::method = tapkee_method,
 			 tapkee::computation_strategy = tapkee_computation_strategy,
@@ -404,6 +403,7 @@ int run(int argc, const char** argv)
 			 tapkee::num_neighbors = k,
 			 tapkee::target_dimension = target_dim,
 			 tapkee::diffusion_map_timesteps = timesteps,
+			 tapkee::diffusion_map_nystrom = nystrom,
 			 tapkee::gaussian_kernel_width = width,
 			 tapkee::max_iteration = max_iters,
 			 tapkee::spe_global_strategy = spe_global,
@@ -415,45 +415,697 @@ int run(int argc, const char** argv)
 			 tapkee::fa_epsilon = fa_eps,
 			 tapkee::sne_perplexity = perplexity,
 			 tapkee::sne_theta = theta,
-			 tapkee::squishing_rate = squishing];
+			 tapkee::squishing_rate = squishing,
+			 tapkee::collapse_duplicates = collapse,
+			 tapkee::sample_size = sample_size,
+			 tapkee::sampling_method = tapkee_sampling_method];
+	return true;
+}
 
+//! Splits the string into tokens just like the shell does
+vector<string> tokenize(const string& line)
+{
+	int n_tokens = 0;
+	char** tokens = CommandLineToArgvA(const_cast<char*>(line.c_str()),&n_tokens);
+	vector<string> result(tokens,tokens+n_tokens);
+	free(tokens);
+	return result;
+}
 
+//! Parses parameters from options given as tokens, options that 
+//! are not set there are taken from the command line
+bool parameters_from_tokens(const vector<string>& tokens, int argc, const char** argv,
+                            tapkee::ParametersSet& parameters, bool& transpose_output)
+{
+	// tokens go first since the first occurrence of an option is used
+	vector<const char*> tokens_argv;
+	tokens_argv.push_back(argv[0]);
+	for (size_t i=0; i<tokens.size(); ++i)
+		tokens_argv.push_back(tokens[i].c_str());
+	for (int i=1; i<argc; ++i)
+		tokens_argv.push_back(argv[i]);
+
+	ezOptionParser opt;
+	add_options(opt);
+	opt.parse(static_cast<int>(tokens_argv.size()),&tokens_argv[0]);
+	transpose_output = opt.isSet(OPT_LONG_PREFIX TRANSPOSE_OUTPUT_KEYWORD) != 0;
+	return parameters_from_options(opt,parameters);
+}
+
+//! Pairwise matrices shared by all embeddings of the same data
+struct PairwiseMatrices
+{
+	tapkee::DenseMatrix distance;
+	tapkee::DenseMatrix kernel;
+};
+
+void precompute_matrices(const tapkee::DenseMatrix& input_data, tapkee::DimensionReductionMethod method, 
+                         PairwiseMatrices& matrices)
+{
+#ifdef USE_PRECOMPUTED
+	if (method_needs_distance(method) && matrices.distance.size()==0)
+	{
+		tapkee::tapkee_internal::timed_context context("[+] Distance matrix computation");
+		matrices.distance = 
+			matrix_from_callback(static_cast<tapkee::IndexType>(input_data.cols()),
+			                     tapkee::eigen_distance_callback(input_data));
+	} 
+	if (method_needs_kernel(method) && matrices.kernel.size()==0)
+	{
+		tapkee::tapkee_internal::timed_context context("[+] Kernel matrix computation");
+		matrices.kernel = 
+			matrix_from_callback(static_cast<tapkee::IndexType>(input_data.cols()),
+			                     tapkee::eigen_kernel_callback(input_data));
+	}
+#else
+	(void)input_data;
+	(void)method;
+	(void)matrices;
+#endif
+}
+
+tapkee::TapkeeOutput embed_data(const tapkee::DenseMatrix& input_data, const tapkee::ParametersSet& parameters,
+                                const PairwiseMatrices& matrices)
+{
 #ifdef USE_PRECOMPUTED
 	vector<tapkee::IndexType> indices(input_data.cols());
 	for (tapkee::IndexType i=0; i<input_data.cols(); ++i)
 		indices[i] = i;
 
-	tapkee::DenseMatrix distance_matrix;
-	tapkee::DenseMatrix kernel_matrix;
-	{
-		if (method_needs_distance(tapkee_method))
-		{
-			tapkee::tapkee_internal::timed_context context("[+] Distance matrix computation");
-			distance_matrix = 
-				matrix_from_callback(static_cast<tapkee::IndexType>(input_data.cols()),
-				                     tapkee::eigen_distance_callback(input_data));
-		} 
-		if (method_needs_kernel(tapkee_method))
-		{
-			tapkee::tapkee_internal::timed_context context("[+] Kernel matrix computation");
-			kernel_matrix = 
-				matrix_from_callback(static_cast<tapkee::IndexType>(input_data.cols()),
-				                     tapkee::eigen_kernel_callback(input_data));
-		}
-	}
-	tapkee::precomputed_distance_callback dcb(distance_matrix);
-	tapkee::precomputed_kernel_callback kcb(kernel_matrix);
+	tapkee::precomputed_distance_callback dcb(matrices.distance);
+	tapkee::precomputed_kernel_callback kcb(matrices.kernel);
 	tapkee::eigen_features_callback fcb(input_data);
 
-	output = tapkee::initialize()
+	return tapkee::initialize()
 		.withParameters(parameters)
 		.withKernel(kcb).withDistance(dcb).withFeatures(fcb)
 	 	.embedRange(indices.begin(),indices.end());
 #else
-	output = tapkee::initialize()
+	(void)matrices;
+	return tapkee::initialize()
 		.withParameters(parameters)
 		.embedUsing(input_data);
 #endif
+}
+
+//! Returns neighbors of each of vectors sorted by distance so they
+//! could be shared by embeddings with any smaller number of neighbors
+tapkee::tapkee_internal::Neighbors shared_neighbors(const tapkee::DenseMatrix& input_data, 
+                                                   tapkee::NeighborsMethod method, tapkee::IndexType k)
+{
+	tapkee::tapkee_internal::timed_context context("[+] Shared neighbors computation");
+
+	vector<tapkee::IndexType> indices(input_data.cols());
+	for (tapkee::IndexType i=0; i<input_data.cols(); ++i)
+		indices[i] = i;
+
+	typedef tapkee::tapkee_internal::PlainDistance<vector<tapkee::IndexType>::iterator,tapkee::eigen_distance_callback> 
+		Distance;
+	tapkee::eigen_distance_callback dcb(input_data);
+	tapkee::eigen_features_callback fcb(input_data);
+	tapkee::tapkee_internal::Neighbors neighbors = 
+		tapkee::tapkee_internal::find_neighbors(method,indices.begin(),indices.end(),
+			Distance(dcb),fcb,static_cast<tapkee::IndexType>(input_data.rows()),k,true);
+	tapkee::tapkee_internal::sort_neighbors(indices.begin(),dcb,neighbors);
+	return neighbors;
+}
+
+//! Returns whether the embedding could use shared neighbors,
+//! it couldn't if it embeds only a subset of vectors
+bool uses_shared_neighbors(const tapkee::ParametersSet& parameters)
+{
+	tapkee::DimensionReductionMethod method = parameters[tapkee::method];
+	tapkee::IndexType sample_size = parameters[tapkee::sample_size];
+	bool collapse = parameters[tapkee::collapse_duplicates];
+	return method_needs_neighbors(method) && !collapse && sample_size==0;
+}
+
+double wall_clock()
+{
+#ifdef _OPENMP
+	return omp_get_wtime();
+#else
+	return double(clock())/CLOCKS_PER_SEC;
+#endif
+}
+
+//! Returns available physical memory in bytes or 0 if it is unknown
+size_t available_memory()
+{
+#if defined(_SC_AVPHYS_PAGES) && defined(_SC_PAGESIZE)
+	long pages = sysconf(_SC_AVPHYS_PAGES);
+	long page_size = sysconf(_SC_PAGESIZE);
+	if (pages > 0 && page_size > 0)
+		return static_cast<size_t>(pages)*static_cast<size_t>(page_size);
+#endif
+	return 0;
+}
+
+//! A configuration of the parameter sweep
+struct SweepConfiguration
+{
+	SweepConfiguration(const string& line) : 
+		options(line), parameters(), transpose_output(false), valid(false),
+		shares_neighbors(false), seconds(0.0), status("not run")
+	{
+	}
+	//! options as listed in the sweep file
+	string options;
+	tapkee::ParametersSet parameters;
+	bool transpose_output;
+	bool valid;
+	//! whether the shared neighborhood graph is used
+	bool shares_neighbors;
+	double seconds;
+	string status;
+};
+
+//! Embeds the data with each of configurations listed in the sweep file.
+//! Data is loaded once and the neighborhood graph is computed once for the 
+//! largest number of neighbors among configurations that use it, then it
+//! is truncated for each of them. Pairwise matrices are shared as well.
+//! Independent configurations are embedded concurrently if asked and
+//! if there is enough memory.
+int run_sweep(int argc, const char** argv, ezOptionParser& opt, 
+              const tapkee::DenseMatrix& input_data, const string& output_filename)
+{
+	string sweep_filename;
+	opt.get(OPT_LONG_PREFIX SWEEP_KEYWORD)->getString(sweep_filename);
+	ifstream sweep_ifs(sweep_filename.c_str());
+	if (!sweep_ifs)
+	{
+		tapkee::LoggingSingleton::instance().message_error("Can't open sweep file " + sweep_filename);
+		return 0;
+	}
+
+	vector<SweepConfiguration> configurations;
+	string line;
+	while (getline(sweep_ifs,line))
+	{
+		size_t first = line.find_first_not_of(" \t\r");
+		if (first == string::npos || line[first] == '#')
+			continue;
+		size_t last = line.find_last_not_of(" \t\r");
+		configurations.push_back(SweepConfiguration(line.substr(first,last-first+1)));
+	}
+	if (configurations.empty())
+	{
+		tapkee::LoggingSingleton::instance().message_error("No configurations in sweep file " + sweep_filename);
+		return 0;
+	}
+
+	for (size_t c=0; c<configurations.size(); ++c)
+	{
+		SweepConfiguration& configuration = configurations[c];
+		configuration.valid = parameters_from_tokens(tokenize(configuration.options),argc,argv,
+		                                             configuration.parameters,configuration.transpose_output);
+		if (!configuration.valid)
+			configuration.status = "invalid options";
+	}
+
+	const tapkee::IndexType n_vectors = input_data.cols();
+
+	// find configurations that could share neighbors and pairwise matrices
+	PairwiseMatrices matrices;
+	tapkee::IndexType max_k = 0;
+	tapkee::NeighborsMethod neighbors_method = tapkee::Brute;
+	size_t max_memory = 0;
+	for (size_t c=0; c<configurations.size(); ++c)
+	{
+		SweepConfiguration& configuration = configurations[c];
+		if (!configuration.valid)
+			continue;
+
+		tapkee::DimensionReductionMethod method = configuration.parameters[tapkee::method];
+		tapkee::IndexType k = configuration.parameters[tapkee::num_neighbors];
+		tapkee::EigenMethod eigen_method = configuration.parameters[tapkee::eigen_method];
+
+		precompute_matrices(input_data,method,matrices);
+		max_memory = std::max(max_memory,method_memory_estimate(method,eigen_method,n_vectors,k));
+		if (uses_shared_neighbors(configuration.parameters))
+		{
+			if (max_k == 0)
+				neighbors_method = configuration.parameters[tapkee::neighbors_method];
+			configuration.shares_neighbors = true;
+			max_k = std::max(max_k,k);
+		}
+	}
+
+	tapkee::tapkee_internal::Neighbors neighbors;
+	if (max_k > 0)
+		neighbors = shared_neighbors(input_data,neighbors_method,max_k);
+
+	int n_jobs = 1;
+	opt.get(OPT_LONG_PREFIX SWEEP_JOBS_KEYWORD)->getInt(n_jobs);
+	n_jobs = std::max(1,std::min(n_jobs,static_cast<int>(configurations.size())));
+	size_t memory = available_memory();
+	if (n_jobs > 1 && memory > 0 && max_memory > 0 && static_cast<size_t>(n_jobs)*max_memory > memory)
+	{
+		int affordable_jobs = std::max(1,static_cast<int>(memory/max_memory));
+		std::stringstream ss;
+		ss << "Not enough memory to run " << n_jobs << " configurations concurrently, running " << affordable_jobs;
+		tapkee::LoggingSingleton::instance().message_warning(ss.str());
+		n_jobs = affordable_jobs;
+	}
+
+	const int n_configurations = static_cast<int>(configurations.size());
+#pragma omp parallel for schedule(dynamic) num_threads(n_jobs) if(n_jobs > 1)
+	for (int c=0; c<n_configurations; ++c)
+	{
+		SweepConfiguration& configuration = configurations[c];
+		if (!configuration.valid)
+			continue;
+
+		std::stringstream configuration_filename;
+		configuration_filename << output_filename << "." << c;
+
+		tapkee::ParametersSet parameters = configuration.parameters;
+		if (configuration.shares_neighbors)
+			parameters.add(tapkee::precomputed_neighbors = static_cast<const tapkee::tapkee_internal::Neighbors*>(&neighbors));
+
+		double start = wall_clock();
+		try
+		{
+			tapkee::TapkeeOutput output = embed_data(input_data,parameters,matrices);
+			configuration.seconds = wall_clock() - start;
+
+			ofstream ofs(configuration_filename.str().c_str());
+			if (configuration.transpose_output)
+				ofs << output.embedding;
+			else
+				ofs << output.embedding.transpose();
+			configuration.status = "ok";
+		}
+		catch (const std::exception& exc)
+		{
+			configuration.seconds = wall_clock() - start;
+			configuration.status = string("failed: ") + exc.what();
+		}
+	}
+
+	string summary_filename = output_filename + ".summary";
+	ofstream summary(summary_filename.c_str());
+	summary << "# index\tseconds\tstatus\toptions\n";
+	for (size_t c=0; c<configurations.size(); ++c)
+	{
+		std::stringstream ss;
+		ss << c << "\t" << configurations[c].seconds << "\t" << configurations[c].status 
+		   << "\t" << configurations[c].options;
+		summary << ss.str() << "\n";
+		tapkee::LoggingSingleton::instance().message_info(ss.str());
+	}
+	summary.close();
+	return 0;
+}
+
+//! A dataset kept in memory by the server
+struct ServedDataset
+{
+	ServedDataset() : data(), matrices(), neighbors(), n_neighbors(0), projection()
+	{
+	}
+	tapkee::DenseMatrix data;
+	PairwiseMatrices matrices;
+	//! neighbors sorted by distance shared by embeddings
+	tapkee::tapkee_internal::Neighbors neighbors;
+	//! number of shared neighbors, 0 if not computed yet
+	tapkee::IndexType n_neighbors;
+	//! projecting function obtained with the last embedding
+	tapkee::ProjectingFunction projection;
+};
+
+typedef std::map<string,ServedDataset> ServedDatasets;
+
+//! Reads data from the file, vectors are in rows unless transposed
+bool load_data(const string& filename, bool transpose, tapkee::DenseMatrix& data, string& error)
+{
+	input_file_stream ifs(filename);
+	if (ifs.peek() == input_file_stream::traits_type::eof())
+	{
+		error = "No data in " + filename;
+		return false;
+	}
+	data = read_data(ifs,transpose);
+	return true;
+}
+
+//! Handles the request of a client, see @ref run_server for the protocol
+//!
+//! @param request request line
+//! @param argc number of command line arguments
+//! @param argv command line arguments
+//! @param datasets datasets kept in memory
+//! @param response response to send to the client
+//! @return false if the server should be shut down
+//!
+bool serve_request(const string& request, int argc, const char** argv,
+                   ServedDatasets& datasets, string& response)
+{
+	vector<string> tokens = tokenize(request);
+	std::stringstream ss;
+	if (tokens.empty())
+	{
+		response = "error Empty request\n";
+		return true;
+	}
+	const string& command = tokens[0];
+	const bool transpose_input = 
+		std::find(tokens.begin(),tokens.end(),string(OPT_LONG_PREFIX TRANSPOSE_INPUT_KEYWORD))!=tokens.end();
+
+	if (command == "shutdown")
+	{
+		response = "ok\n";
+		return false;
+	}
+	if (command == "list")
+	{
+		ss << "ok " << datasets.size() << "\n";
+		for (ServedDatasets::const_iterator it=datasets.begin(); it!=datasets.end(); ++it)
+			ss << it->first << " " << it->second.data.cols() << " " << it->second.data.rows() << "\n";
+		response = ss.str();
+		return true;
+	}
+	if (tokens.size() < 2)
+	{
+		response = "error No dataset name given\n";
+		return true;
+	}
+	const string& name = tokens[1];
+
+	if (command == "load")
+	{
+		if (tokens.size() < 3)
+		{
+			response = "error No input file given\n";
+			return true;
+		}
+		ServedDataset dataset;
+		string error;
+		if (!load_data(tokens[2],transpose_input,dataset.data,error))
+		{
+			response = "error " + error + "\n";
+			return true;
+		}
+		datasets[name] = dataset;
+		ss << "ok " << dataset.data.cols() << " " << dataset.data.rows() << "\n";
+		response = ss.str();
+		return true;
+	}
+
+	ServedDatasets::iterator found = datasets.find(name);
+	if (found == datasets.end())
+	{
+		response = "error No dataset " + name + " loaded\n";
+		return true;
+	}
+	ServedDataset& dataset = found->second;
+
+	if (command == "unload")
+	{
+		datasets.erase(found);
+		response = "ok\n";
+	}
+	else if (command == "embed")
+	{
+		tapkee::ParametersSet parameters;
+		bool transpose_output = false;
+		if (!parameters_from_tokens(vector<string>(tokens.begin()+2,tokens.end()),argc,argv,
+		                            parameters,transpose_output))
+		{
+			response = "error Invalid options\n";
+			return true;
+		}
+
+		double start = wall_clock();
+		precompute_matrices(dataset.data,parameters[tapkee::method],dataset.matrices);
+		if (uses_shared_neighbors(parameters))
+		{
+			tapkee::IndexType k = parameters[tapkee::num_neighbors];
+			if (k > dataset.n_neighbors)
+			{
+				dataset.neighbors = shared_neighbors(dataset.data,parameters[tapkee::neighbors_method],k);
+				dataset.n_neighbors = k;
+			}
+			parameters.add(tapkee::precomputed_neighbors = 
+				static_cast<const tapkee::tapkee_internal::Neighbors*>(&dataset.neighbors));
+		}
+		tapkee::TapkeeOutput output = embed_data(dataset.data,parameters,dataset.matrices);
+		dataset.projection = output.projection;
+
+		const tapkee::DenseMatrix& embedding = output.embedding;
+		ss << "ok " << (transpose_output ? embedding.rows() : embedding.cols()) << " " 
+		   << (transpose_output ? embedding.cols() : embedding.rows()) << " " << wall_clock()-start << "\n";
+		if (transpose_output)
+			ss << embedding << "\n";
+		else
+			ss << embedding.transpose() << "\n";
+		response = ss.str();
+	}
+	else if (command == "project")
+	{
+		if (tokens.size() < 3)
+		{
+			response = "error No input file given\n";
+			return true;
+		}
+		if (!dataset.projection.implementation)
+		{
+			response = "error The last embedding of " + name + " provides no projection\n";
+			return true;
+		}
+		tapkee::DenseMatrix vectors;
+		string error;
+		if (!load_data(tokens[2],transpose_input,vectors,error))
+		{
+			response = "error " + error + "\n";
+			return true;
+		}
+		if (vectors.rows() != dataset.data.rows())
+		{
+			response = "error Dimension of vectors differs from dimension of " + name + "\n";
+			return true;
+		}
+		tapkee::DenseMatrix projected;
+		for (tapkee::IndexType i=0; i<vectors.cols(); ++i)
+		{
+			tapkee::DenseVector projected_vector = dataset.projection(vectors.col(i));
+			if (i == 0)
+				projected.resize(projected_vector.size(),vectors.cols());
+			projected.col(i) = projected_vector;
+		}
+		ss << "ok " << projected.rows() << " " << projected.cols() << "\n" << projected << "\n";
+		response = ss.str();
+	}
+	else
+		response = "error Unknown command " + command + "\n";
+	return true;
+}
+
+//! Serves embedding requests over the Unix domain socket keeping
+//! loaded datasets, their neighbors, pairwise matrices and projecting 
+//! functions in memory between requests. Each request is a line, 
+//! each response starts with either 'ok' or 'error <message>' line.
+//!
+//! - load NAME FILE [--transpose-input]: loads data, responds with
+//!   'ok VECTORS DIMENSION'
+//! - embed NAME [OPTIONS]: embeds the data with any of options of the 
+//!   application (options not set are taken from the command line), 
+//!   responds with 'ok ROWS COLUMNS SECONDS' followed by rows of the
+//!   embedding written just like the output file
+//! - project NAME FILE [--transpose-input]: projects vectors with the
+//!   projecting function of the last embedding of the data, responds 
+//!   with 'ok ROWS COLUMNS' followed by rows of projected vectors
+//! - unload NAME: forgets the data
+//! - list: responds with 'ok N' followed by N lines 'NAME VECTORS DIMENSION'
+//! - shutdown: stops the server
+//!
+int run_server(int argc, const char** argv, ezOptionParser& opt)
+{
+	string socket_path;
+	opt.get(OPT_LONG_PREFIX SERVE_KEYWORD)->getString(socket_path);
+
+	UnixSocketServer server;
+	string error;
+	if (!server.listen(socket_path,error))
+	{
+		tapkee::LoggingSingleton::instance().message_error("Can't listen on " + socket_path + ": " + error);
+		return 0;
+	}
+	tapkee::LoggingSingleton::instance().message_info("Listening on " + socket_path);
+
+	ServedDatasets datasets;
+	bool running = true;
+	while (running && server.accept())
+	{
+		string request;
+		while (running && server.read_line(request))
+		{
+			tapkee::LoggingSingleton::instance().message_info("Request: " + request);
+			string response;
+			try
+			{
+				running = serve_request(request,argc,argv,datasets,response);
+			}
+			catch (const std::exception& exc)
+			{
+				response = string("error ") + exc.what() + "\n";
+			}
+			if (!server.write(response))
+				break;
+		}
+	}
+	server.close();
+	return 0;
+}
+
+int run(int argc, const char** argv)
+{
+	srand(static_cast<unsigned int>(time(NULL)));
+
+	ezOptionParser opt;
+	opt.footer = "Copyright (C) 2012-2013 Sergey Lisitsyn <lisitsyn.s.o@gmail.com>, Fernando Iglesias <fernando.iglesiasg@gmail.com>\n"
+	             "This is free software: you are free to change and redistribute it.\n"
+	             "There is NO WARRANTY, to the extent permitted by law.";
+	opt.overview = "Tapkee library application for reduction dimensions of dense matrices.\n"
+	               "Git " TAPKEE_CURRENT_GIT_INFO;
+	opt.example = "Run locally linear embedding with k=10 with arpack "
+                  "eigensolver on data from input.dat saving embedding to output.dat \n\n"
+	              "tapkee -i input.dat -o output.dat --method lle --eigen-method arpack -k 10\n\n";
+	opt.syntax = "tapkee [options]\n";
+
+	add_options(opt);
+
+	opt.parse(argc, argv);
+
+	if (opt.isSet(OPT_LONG_PREFIX HELP_KEYWORD))
+	{
+		string usage;
+		opt.getUsage(usage);
+		std::cout << usage << std::endl;
+		return 0;
+	}
+
+	if (opt.isSet(OPT_LONG_PREFIX VERBOSE_KEYWORD))
+	{
+		tapkee::LoggingSingleton::instance().enable_info();
+	}
+	if (opt.isSet(OPT_LONG_PREFIX DEBUG_KEYWORD))
+	{
+		tapkee::LoggingSingleton::instance().enable_debug();
+		tapkee::LoggingSingleton::instance().message_info("Debug messages enabled");
+	}
+
+	if (opt.isSet(OPT_LONG_PREFIX BENCHMARK_KEYWORD))
+	{
+		tapkee::LoggingSingleton::instance().enable_benchmark();
+		tapkee::LoggingSingleton::instance().message_info("Benchmarking enabled");
+	}
+	
+	if (opt.isSet(OPT_LONG_PREFIX SERVE_KEYWORD))
+		return run_server(argc,argv,opt);
+
+	tapkee::ParametersSet parameters;
+	if (!parameters_from_options(opt,parameters))
+		return 0;
+
+	// Load data
+	string input_filename;
+	string output_filename;
+	if (!opt.isSet(OPT_LONG_PREFIX INPUT_FILE_KEYWORD))
+	{
+		tapkee::LoggingSingleton::instance().message_error("No input file specified. Please use " OPT_PREFIX "h flag if stucked");
+		return 0;
+	}
+	else
+		opt.get(OPT_LONG_PREFIX INPUT_FILE_KEYWORD)->getString(input_filename);
+
+	if (!opt.isSet(OPT_LONG_PREFIX OUTPUT_FILE_KEYWORD) && opt.isSet(OPT_LONG_PREFIX SWEEP_KEYWORD))
+	{
+		tapkee::LoggingSingleton::instance().message_error("No output file specified, it is required to save results of the sweep");
+		return 0;
+	}
+	else if (!opt.isSet(OPT_LONG_PREFIX OUTPUT_FILE_KEYWORD))
+	{
+		tapkee::LoggingSingleton::instance().message_warning("No output file specified, using /dev/tty");
+		output_filename = "/dev/tty";
+	}
+	else
+		opt.get(OPT_LONG_PREFIX OUTPUT_FILE_KEYWORD)->getString(output_filename);
+
+	bool output_projection = false;
+	std::string output_matrix_filename = "/dev/null";
+	std::string output_mean_filename = "/dev/null";
+	if (opt.isSet(OPT_LONG_PREFIX OUTPUT_PROJECTION_MATRIX_FILE_KEYWORD) &&
+		opt.isSet(OPT_LONG_PREFIX OUTPUT_PROJECTION_MEAN_FILE_KEYWORD))
+	{
+		output_projection = true;
+		opt.get(OPT_LONG_PREFIX OUTPUT_PROJECTION_MATRIX_FILE_KEYWORD)->getString(output_matrix_filename);
+		opt.get(OPT_LONG_PREFIX OUTPUT_PROJECTION_MEAN_FILE_KEYWORD)->getString(output_mean_filename);
+	}
+
+	InputFormat input_format = DenseInput;
+	{
+		string format;
+		opt.get(OPT_LONG_PREFIX INPUT_FORMAT_KEYWORD)->getString(format);
+		try
+		{
+			input_format = parse_input_format(format.c_str());
+		}
+		catch (const std::exception&)
+		{
+			tapkee::LoggingSingleton::instance().message_error(string("Unknown input format ") + format);
+			return 0;
+		}
+	}
+	if (input_format != DenseInput && opt.isSet(OPT_LONG_PREFIX SWEEP_KEYWORD))
+	{
+		tapkee::LoggingSingleton::instance().message_error("Sweep is supported only for the dense input format");
+		return 0;
+	}
+
+	input_file_stream ifs(input_filename);
+	const bool transpose_input = opt.isSet(OPT_LONG_PREFIX TRANSPOSE_INPUT_KEYWORD);
+	tapkee::DenseMatrix input_data;
+	tapkee::SparseMatrix sparse_input_data;
+	{
+		tapkee::tapkee_internal::timed_context context("[+] Data loading");
+		if (input_format == LibSVMInput)
+			sparse_input_data = read_libsvm(ifs);
+		else if (input_format == MatrixMarketInput)
+			sparse_input_data = read_matrix_market(ifs,transpose_input);
+		else
+			input_data = read_data(ifs,transpose_input);
+	}
+	
+	std::stringstream ss;
+	if (input_format == DenseInput)
+		ss << "Data contains " << input_data.cols() << " feature vectors with dimension of " << input_data.rows();
+	else
+		ss << "Data contains " << sparse_input_data.cols() << " sparse feature vectors with dimension of " 
+		   << sparse_input_data.rows() << " and " << sparse_input_data.nonZeros() << " non-zero entries";
+	tapkee::LoggingSingleton::instance().message_info(ss.str());
+
+	if (opt.isSet(OPT_LONG_PREFIX SWEEP_KEYWORD))
+		return run_sweep(argc,argv,opt,input_data,output_filename);
+
+	ofstream ofs(output_filename.c_str());
+	ofstream ofs_matrix(output_matrix_filename.c_str());
+	ofstream ofs_mean(output_matrix_filename.c_str());
+	
+	tapkee::TapkeeOutput output;
+	if (input_format == DenseInput)
+	{
+		PairwiseMatrices matrices;
+		precompute_matrices(input_data,parameters[tapkee::method],matrices);
+		output = embed_data(input_data,parameters,matrices);
+	}
+	else
+	{
+		output = tapkee::initialize()
+			.withParameters(parameters)
+			.embedUsing(sparse_input_data);
+	}
+
 	// Save obtained data
 	if (opt.isSet(OPT_LONG_PREFIX TRANSPOSE_OUTPUT_KEYWORD))
 		ofs << output.embedding;
@@ -470,9 +1122,10 @@ int run(int argc, const char** argv)
 	ofs_matrix.close();
 	ofs_mean.close();
 	return 0;
+}
+
 #undef OPT_PREFIX
 #undef OPT_LONG_PREFIX
-}
 
 int main(int argc, const char** argv)
 {
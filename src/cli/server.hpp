@@ -0,0 +1,206 @@
+/* This software is distributed under BSD 3-clause license (see LICENSE file).
+ *
+ * Copyright (c) 2012-2013 Sergey Lisitsyn, Fernando Iglesias
+ */
+
+#ifndef TAPKEE_APP_SERVER_H_
+#define TAPKEE_APP_SERVER_H_
+
+#if defined(__unix__) || defined(__APPLE__)
+	#define TAPKEE_APP_WITH_UNIX_SOCKETS
+#endif
+
+#ifdef TAPKEE_APP_WITH_UNIX_SOCKETS
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <signal.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+#include <string>
+
+//! Line-based server over a Unix domain socket. Clients are
+//! served one at a time, each of them could send any number of
+//! requests until the connection is closed.
+class UnixSocketServer
+{
+public:
+	UnixSocketServer() : path(), listening(-1), connection(-1), buffer()
+	{
+	}
+	~UnixSocketServer()
+	{
+		close();
+	}
+
+	//! Starts listening on the socket at the provided path, an existing
+	//! socket is replaced but no other kinds of files are
+	//!
+	//! @param socket_path path to the socket
+	//! @param error description of the error if any
+	//! @return true if succeeded
+	//!
+	bool listen(const std::string& socket_path, std::string& error)
+	{
+#ifdef TAPKEE_APP_WITH_UNIX_SOCKETS
+		sockaddr_un address;
+		if (socket_path.size() >= sizeof(address.sun_path))
+		{
+			error = "Socket path is too long";
+			return false;
+		}
+		struct stat status;
+		if (lstat(socket_path.c_str(),&status) == 0)
+		{
+			if (!S_ISSOCK(status.st_mode))
+			{
+				error = socket_path + " exists and is not a socket";
+				return false;
+			}
+			unlink(socket_path.c_str());
+		}
+
+		// writing to a closed connection shouldn't terminate the server
+		signal(SIGPIPE,SIG_IGN);
+
+		listening = socket(AF_UNIX,SOCK_STREAM,0);
+		if (listening < 0)
+		{
+			error = strerror(errno);
+			return false;
+		}
+		memset(&address,0,sizeof(address));
+		address.sun_family = AF_UNIX;
+		strncpy(address.sun_path,socket_path.c_str(),sizeof(address.sun_path)-1);
+		if (bind(listening,reinterpret_cast<sockaddr*>(&address),sizeof(address)) < 0 ||
+		    ::listen(listening,16) < 0)
+		{
+			error = strerror(errno);
+			::close(listening);
+			listening = -1;
+			return false;
+		}
+		path = socket_path;
+		return true;
+#else
+		(void)socket_path;
+		error = "Unix domain sockets are not supported on this platform";
+		return false;
+#endif
+	}
+
+	//! Waits for the next client, the previous connection is closed
+	//! @return true if a client is connected
+	bool accept()
+	{
+#ifdef TAPKEE_APP_WITH_UNIX_SOCKETS
+		disconnect();
+		while (connection < 0)
+		{
+			connection = ::accept(listening,NULL,NULL);
+			if (connection < 0 && errno != EINTR)
+				return false;
+		}
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	//! Reads the next line sent by the current client
+	//! @param line read line without the line break
+	//! @return false if the client closed the connection
+	bool read_line(std::string& line)
+	{
+#ifdef TAPKEE_APP_WITH_UNIX_SOCKETS
+		size_t end;
+		while ((end = buffer.find('\n')) == std::string::npos)
+		{
+			char chunk[4096];
+			ssize_t n_read = ::read(connection,chunk,sizeof(chunk));
+			if (n_read < 0 && errno == EINTR)
+				continue;
+			if (n_read <= 0)
+			{
+				// the last line could be not terminated
+				line.swap(buffer);
+				buffer.clear();
+				return !line.empty();
+			}
+			buffer.append(chunk,n_read);
+		}
+		line = buffer.substr(0,end);
+		buffer.erase(0,end+1);
+		if (!line.empty() && line[line.size()-1] == '\r')
+			line.erase(line.size()-1);
+		return true;
+#else
+		(void)line;
+		return false;
+#endif
+	}
+
+	//! Sends the data to the current client
+	//! @return false if the client closed the connection
+	bool write(const std::string& data)
+	{
+#ifdef TAPKEE_APP_WITH_UNIX_SOCKETS
+		size_t written = 0;
+		while (written < data.size())
+		{
+			ssize_t n_written = ::write(connection,data.data()+written,data.size()-written);
+			if (n_written < 0 && errno == EINTR)
+				continue;
+			if (n_written <= 0)
+				return false;
+			written += n_written;
+		}
+		return true;
+#else
+		(void)data;
+		return false;
+#endif
+	}
+
+	//! Closes the current connection and the socket
+	void close()
+	{
+#ifdef TAPKEE_APP_WITH_UNIX_SOCKETS
+		disconnect();
+		if (listening >= 0)
+		{
+			::close(listening);
+			listening = -1;
+			unlink(path.c_str());
+		}
+#endif
+	}
+
+private:
+
+	UnixSocketServer(const UnixSocketServer&);
+	UnixSocketServer& operator=(const UnixSocketServer&);
+
+	void disconnect()
+	{
+#ifdef TAPKEE_APP_WITH_UNIX_SOCKETS
+		if (connection >= 0)
+		{
+			::close(connection);
+			connection = -1;
+		}
+		buffer.clear();
+#endif
+	}
+
+	std::string path;
+	int listening;
+	int connection;
+	std::string buffer;
+};
+
+#endif
@@ -10,6 +10,9 @@
 #include <fstream>
 #include <ostream>
 #include <iterator>
+#include <algorithm>
+#include <cstdlib>
+#include <cctype>
 
 using namespace std;
 
@@ -22,7 +25,7 @@ inline bool is_wrong_char(char c) {
 } 
 
 // TODO this absolutely unexceptionally definitive should be improved later
-tapkee::DenseMatrix read_data(ifstream& ifs)
+tapkee::DenseMatrix read_data(istream& ifs, bool transpose=false)
 {
 	string str;
 	vector< vector<tapkee::ScalarType> > input_data;
@@ -43,21 +46,265 @@ tapkee::DenseMatrix read_data(ifstream& ifs)
 		}
 	}
 
-	tapkee::DenseMatrix fm(input_data.size(),input_data[0].size());
-	for (int i=0; i<fm.rows(); i++)
+	const int n_lines = input_data.size();
+	const int n_values = input_data[0].size();
+	// lines are written to columns of the matrix right away
+	// if transposed so no transposed copy is needed later
+	tapkee::DenseMatrix fm = transpose ? 
+		tapkee::DenseMatrix(n_values,n_lines) : tapkee::DenseMatrix(n_lines,n_values);
+	for (int i=0; i<n_lines; i++)
 	{
-		if (static_cast<tapkee::DenseMatrix::Index>(input_data[i].size()) != fm.cols()) 
+		if (static_cast<int>(input_data[i].size()) != n_values) 
 		{
 			stringstream ss;
 			ss << "Wrong data at line " << i;
 			throw std::runtime_error(ss.str());
 		}
-		for (int j=0; j<fm.cols(); j++)
-			fm(i,j) = input_data[i][j];
+		for (int j=0; j<n_values; j++)
+		{
+			if (transpose)
+				fm(j,i) = input_data[i][j];
+			else
+				fm(i,j) = input_data[i][j];
+		}
 	}
 	return fm;
 }
 
+enum InputFormat
+{
+	DenseInput,
+	LibSVMInput,
+	MatrixMarketInput
+};
+
+InputFormat parse_input_format(const char* str)
+{
+	if (!strcmp(str,"dense"))
+		return DenseInput;
+	if (!strcmp(str,"libsvm"))
+		return LibSVMInput;
+	if (!strcmp(str,"matrix-market") || !strcmp(str,"mtx"))
+		return MatrixMarketInput;
+
+	throw std::exception();
+	return DenseInput;
+}
+
+typedef Eigen::Triplet<tapkee::ScalarType> SparseEntry;
+
+//! Reads whole contents of the stream and finds lines to parse, 
+//! i.e. lines that are not empty and don't start with the comment char
+void read_lines(istream& ifs, string& contents, vector<size_t>& line_begins, char comment)
+{
+	contents.assign(istreambuf_iterator<char>(ifs),istreambuf_iterator<char>());
+	for (size_t begin=0; begin<contents.size(); )
+	{
+		size_t end = contents.find('\n',begin);
+		if (end == string::npos)
+			end = contents.size();
+		size_t first = contents.find_first_not_of(" \t\r",begin);
+		if (first < end && contents[first] != comment)
+			line_begins.push_back(first);
+		begin = end+1;
+	}
+}
+
+//! Skips spaces and tabs, returns false if the line is over
+inline bool skip_blanks(const char*& p)
+{
+	while (*p == ' ' || *p == '\t' || *p == '\r')
+		++p;
+	return *p != '\n' && *p != '\0';
+}
+
+//! Parses lines of the range in parallel with the parse function that
+//! is given the line and its index and fills entries. Lines are split
+//! into chunks so each chunk is parsed to its own storage, entries of
+//! chunks are concatenated in order afterwards.
+template <class LineParser>
+vector<SparseEntry> parse_lines(const string& contents, const vector<size_t>& line_begins, 
+                                size_t first_line, LineParser parser)
+{
+	const int chunk_size = 4096;
+	const int n_lines = static_cast<int>(line_begins.size()-first_line);
+	const int n_chunks = (n_lines + chunk_size - 1)/chunk_size;
+	vector< vector<SparseEntry> > chunk_entries(n_chunks);
+	vector<string> chunk_errors(n_chunks);
+
+#pragma omp parallel for schedule(dynamic)
+	for (int c=0; c<n_chunks; ++c)
+	{
+		for (int i=c*chunk_size; i<std::min(n_lines,(c+1)*chunk_size) && chunk_errors[c].empty(); ++i)
+		{
+			// exceptions can't leave the parallel region
+			if (!parser(contents.c_str()+line_begins[first_line+i],i,chunk_entries[c]))
+			{
+				stringstream ss;
+				ss << "Wrong data at line " << i+first_line;
+				chunk_errors[c] = ss.str();
+			}
+		}
+	}
+
+	size_t n_entries = 0;
+	for (int c=0; c<n_chunks; ++c)
+	{
+		if (!chunk_errors[c].empty())
+			throw std::runtime_error(chunk_errors[c]);
+		n_entries += chunk_entries[c].size();
+	}
+	vector<SparseEntry> entries;
+	entries.reserve(n_entries);
+	for (int c=0; c<n_chunks; ++c)
+	{
+		entries.insert(entries.end(),chunk_entries[c].begin(),chunk_entries[c].end());
+		vector<SparseEntry>().swap(chunk_entries[c]);
+	}
+	return entries;
+}
+
+//! Parses 'label index:value index:value ...' lines with 1-based indices,
+//! labels and other tokens without values (e.g. 'qid:1') are skipped
+struct LibSVMLineParser
+{
+	bool operator()(const char* p, int line, vector<SparseEntry>& entries) const
+	{
+		bool label = true;
+		while (skip_blanks(p))
+		{
+			char* next = NULL;
+			long index = strtol(p,&next,10);
+			if (label || next == p || *next != ':' || index < 1)
+			{
+				// labels and tokens like qid:1 are skipped
+				while (*p && !isspace(static_cast<unsigned char>(*p)))
+					++p;
+				label = false;
+				continue;
+			}
+			p = next+1;
+			if (isspace(static_cast<unsigned char>(*p)))
+				return false;
+			tapkee::ScalarType value = strtod(p,&next);
+			if (next == p)
+				return false;
+			entries.push_back(SparseEntry(static_cast<int>(index-1),line,value));
+			p = next;
+		}
+		return true;
+	}
+};
+
+//! Reads the LibSVM file into the sparse matrix with
+//! a feature vector per line in columns
+tapkee::SparseMatrix read_libsvm(istream& ifs)
+{
+	string contents;
+	vector<size_t> line_begins;
+	read_lines(ifs,contents,line_begins,'#');
+	vector<SparseEntry> entries = parse_lines(contents,line_begins,0,LibSVMLineParser());
+
+	int dimension = 0;
+	for (size_t i=0; i<entries.size(); ++i)
+		dimension = std::max(dimension,entries[i].row()+1);
+
+	tapkee::SparseMatrix matrix(dimension,static_cast<int>(line_begins.size()));
+	matrix.setFromTriplets(entries.begin(),entries.end());
+	return matrix;
+}
+
+//! Parses 'row column [value]' lines of the MatrixMarket 
+//! coordinate format with 1-based indices
+struct MatrixMarketLineParser
+{
+	MatrixMarketLineParser(bool p, bool t, int r, int c) : pattern(p), transpose(t), rows(r), cols(c)
+	{
+	}
+	bool operator()(const char* p, int, vector<SparseEntry>& entries) const
+	{
+		// blanks are skipped explicitly so values are never read from the next line
+		char* next = NULL;
+		long row = strtol(p,&next,10);
+		if (next == p)
+			return false;
+		p = next;
+		if (!skip_blanks(p))
+			return false;
+		long col = strtol(p,&next,10);
+		if (next == p)
+			return false;
+		p = next;
+		tapkee::ScalarType value = 1.0;
+		if (!pattern)
+		{
+			if (!skip_blanks(p))
+				return false;
+			value = strtod(p,&next);
+			if (next == p)
+				return false;
+		}
+		if (row < 1 || row > rows || col < 1 || col > cols)
+			return false;
+		if (transpose)
+			entries.push_back(SparseEntry(static_cast<int>(col-1),static_cast<int>(row-1),value));
+		else
+			entries.push_back(SparseEntry(static_cast<int>(row-1),static_cast<int>(col-1),value));
+		return true;
+	}
+	bool pattern;
+	bool transpose;
+	int rows;
+	int cols;
+};
+
+//! Reads the MatrixMarket coordinate file into the sparse matrix,
+//! feature vectors are in columns unless transposed just like
+//! for the dense input
+tapkee::SparseMatrix read_matrix_market(istream& ifs, bool transpose=false)
+{
+	string contents;
+	vector<size_t> line_begins;
+	read_lines(ifs,contents,line_begins,'%');
+
+	string header = contents.substr(0,contents.find('\n'));
+	std::transform(header.begin(),header.end(),header.begin(),::tolower);
+	stringstream header_stream(header);
+	string banner, object, format, field, symmetry;
+	header_stream >> banner >> object >> format >> field >> symmetry;
+	if (banner != "%%matrixmarket" || object != "matrix" || format != "coordinate")
+		throw std::runtime_error("Only MatrixMarket files of coordinate matrices are supported");
+	if (field != "real" && field != "integer" && field != "pattern")
+		throw std::runtime_error("Only real, integer and pattern MatrixMarket matrices are supported");
+	if (symmetry != "general" && symmetry != "symmetric")
+		throw std::runtime_error("Only general and symmetric MatrixMarket matrices are supported");
+	if (line_begins.empty())
+		throw std::runtime_error("No size line in the MatrixMarket file");
+
+	int rows = 0, cols = 0, n_entries = 0;
+	stringstream size_stream(contents.substr(line_begins[0],contents.find('\n',line_begins[0])-line_begins[0]));
+	if (!(size_stream >> rows >> cols >> n_entries))
+		throw std::runtime_error("Wrong size line in the MatrixMarket file");
+	if (static_cast<int>(line_begins.size())-1 != n_entries)
+		throw std::runtime_error("Number of entries differs from the one given in the MatrixMarket file");
+
+	vector<SparseEntry> entries = parse_lines(contents,line_begins,1,
+		MatrixMarketLineParser(field=="pattern",transpose,rows,cols));
+	if (symmetry == "symmetric")
+	{
+		const size_t n_stored = entries.size();
+		for (size_t i=0; i<n_stored; ++i)
+		{
+			if (entries[i].row() != entries[i].col())
+				entries.push_back(SparseEntry(entries[i].col(),entries[i].row(),entries[i].value()));
+		}
+	}
+
+	tapkee::SparseMatrix matrix(transpose ? cols : rows, transpose ? rows : cols);
+	matrix.setFromTriplets(entries.begin(),entries.end());
+	return matrix;
+}
+
 bool method_needs_kernel(tapkee::DimensionReductionMethod method) 
 {
 	switch (method)
@@ -75,6 +322,7 @@ bool method_needs_kernel(tapkee::DimensionReductionMethod method)
 		IF_NEEDS_KERNEL(tapkee::PCA);
 		IF_NEEDS_KERNEL(tapkee::RandomProjection);
 		IF_NEEDS_KERNEL(tapkee::LaplacianEigenmaps);
+		IF_NEEDS_KERNEL(tapkee::LandmarkLaplacianEigenmaps);
 		IF_NEEDS_KERNEL(tapkee::LocalityPreservingProjections);
 		IF_NEEDS_KERNEL(tapkee::NeighborhoodPreservingEmbedding);
 		IF_NEEDS_KERNEL(tapkee::LinearLocalTangentSpaceAlignment);
@@ -105,6 +353,7 @@ bool method_needs_distance(tapkee::DimensionReductionMethod method)
 		IF_NEEDS_DISTANCE(tapkee::PCA);
 		IF_NEEDS_DISTANCE(tapkee::RandomProjection);
 		IF_NEEDS_DISTANCE(tapkee::LaplacianEigenmaps);
+		IF_NEEDS_DISTANCE(tapkee::LandmarkLaplacianEigenmaps);
 		IF_NEEDS_DISTANCE(tapkee::LocalityPreservingProjections);
 		IF_NEEDS_DISTANCE(tapkee::NeighborhoodPreservingEmbedding);
 		IF_NEEDS_DISTANCE(tapkee::LinearLocalTangentSpaceAlignment);
@@ -118,6 +367,55 @@ bool method_needs_distance(tapkee::DimensionReductionMethod method)
 	return false;
 }
 
+bool method_needs_neighbors(tapkee::DimensionReductionMethod method)
+{
+	switch (method)
+	{
+		case tapkee::KernelLocallyLinearEmbedding:
+		case tapkee::KernelLocalTangentSpaceAlignment:
+		case tapkee::HessianLocallyLinearEmbedding:
+		case tapkee::Isomap:
+		case tapkee::LandmarkIsomap:
+		case tapkee::LaplacianEigenmaps:
+		case tapkee::LocalityPreservingProjections:
+		case tapkee::NeighborhoodPreservingEmbedding:
+		case tapkee::LinearLocalTangentSpaceAlignment:
+		case tapkee::StochasticProximityEmbedding:
+		case tapkee::ManifoldSculpting:
+			return true;
+		default:
+			return false;
+	}
+}
+
+//! Returns rough estimate of memory in bytes required to embed n vectors
+//! with the method, methods that need dense n x n matrices dominate
+size_t method_memory_estimate(tapkee::DimensionReductionMethod method, tapkee::EigenMethod eigen_method, 
+                              size_t n, size_t k)
+{
+	const size_t dense = 3*n*n*sizeof(tapkee::ScalarType);
+	switch (method)
+	{
+		case tapkee::MultidimensionalScaling:
+		case tapkee::Isomap:
+		case tapkee::DiffusionMap:
+		case tapkee::KernelPCA:
+			return dense;
+		case tapkee::KernelLocallyLinearEmbedding:
+		case tapkee::KernelLocalTangentSpaceAlignment:
+		case tapkee::HessianLocallyLinearEmbedding:
+		case tapkee::LaplacianEigenmaps:
+		case tapkee::LocalityPreservingProjections:
+		case tapkee::NeighborhoodPreservingEmbedding:
+		case tapkee::LinearLocalTangentSpaceAlignment:
+			if (eigen_method.is(tapkee::Dense))
+				return dense;
+			return 4*n*k*k*sizeof(tapkee::ScalarType);
+		default:
+			return 4*n*(k+16)*sizeof(tapkee::ScalarType);
+	}
+}
+
 tapkee::DimensionReductionMethod parse_reduction_method(const char* str)
 {
 	if (!strcmp(str,"local_tangent_space_alignment") || !strcmp(str,"ltsa"))
@@ -144,6 +442,8 @@ tapkee::DimensionReductionMethod parse_reduction_method(const char* str)
 		return tapkee::RandomProjection;
 	if (!strcmp(str,"laplacian_eigenmaps") || !strcmp(str,"la"))
 		return tapkee::LaplacianEigenmaps;
+	if (!strcmp(str,"landmark_laplacian_eigenmaps") || !strcmp(str,"l-la"))
+		return tapkee::LandmarkLaplacianEigenmaps;
 	if (!strcmp(str,"locality_preserving_projections") || !strcmp(str,"lpp"))
 		return tapkee::LocalityPreservingProjections;
 	if (!strcmp(str,"neighborhood_preserving_embedding") || !strcmp(str,"npe"))
@@ -171,6 +471,10 @@ tapkee::NeighborsMethod parse_neighbors_method(const char* str)
 		return tapkee::Brute;
 	if (!strcmp(str,"vptree"))
 		return tapkee::VpTree;
+	if (!strcmp(str,"kdtree"))
+		return tapkee::KdTree;
+	if (!strcmp(str,"balltree"))
+		return tapkee::BallTree;
 #ifdef TAPKEE_USE_LGPL_COVERTREE
 	if (!strcmp(str,"covertree"))
 		return tapkee::CoverTree;
@@ -190,11 +494,26 @@ tapkee::EigenMethod parse_eigen_method(const char* str)
 		return tapkee::Randomized;
 	if (!strcmp(str,"dense"))
 		return tapkee::Dense;
+	if (!strcmp(str,"lobpcg"))
+		return tapkee::Lobpcg;
+	if (!strcmp(str,"chebyshev"))
+		return tapkee::ChebyshevFilter;
 	
 	throw std::exception();
 	return tapkee::Dense;
 }
 
+tapkee::SamplingMethod parse_sampling_method(const char* str)
+{
+	if (!strcmp(str,"uniform"))
+		return tapkee::UniformSampling;
+	if (!strcmp(str,"farthest"))
+		return tapkee::FarthestPointSampling;
+
+	throw std::exception();
+	return tapkee::UniformSampling;
+}
+
 tapkee::ComputationStrategy parse_computation_strategy(const char* str)
 {
 	if (!strcmp(str,"cpu"))
@@ -0,0 +1,20 @@
+SET(ZSTD_SEARCH_PATHS ${ZSTD_DIR})
+
+FIND_PATH(ZSTD_INCLUDE_DIR zstd.h PATHS ${ZSTD_SEARCH_PATHS} PATH_SUFFIXES include)
+FIND_LIBRARY(ZSTD_LIB NAMES zstd PATHS ${ZSTD_SEARCH_PATHS} PATH_SUFFIXES lib)
+
+SET(ZSTD_FOUND FALSE)
+IF (ZSTD_INCLUDE_DIR AND ZSTD_LIB)
+  SET(ZSTD_FOUND TRUE)
+    MARK_AS_ADVANCED(ZSTD_INCLUDE_DIR ZSTD_LIB)
+ENDIF (ZSTD_INCLUDE_DIR AND ZSTD_LIB)
+
+IF (ZSTD_FOUND)
+  IF (NOT Zstd_FIND_QUIETLY)
+     MESSAGE(STATUS "Found zstd : ${ZSTD_LIB}")
+  ENDIF (NOT Zstd_FIND_QUIETLY)
+ELSE(ZSTD_FOUND)
+  IF (Zstd_FIND_REQUIRED)
+     MESSAGE(FATAL_ERROR "Could not find zstd")
+  ENDIF (Zstd_FIND_REQUIRED)
+ENDIF (ZSTD_FOUND)
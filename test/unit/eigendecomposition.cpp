@@ -125,3 +125,317 @@ TEST(EigenDecomposition, RandomizedDenseLargestEigenvector)
 	// check if it is an eigenvector
 	ASSERT_NEAR(0.0,(mat*result.first - result.second[0]*result.first).norm(),PRECISION);
 }
+
+TEST(EigenDecomposition, LobpcgDenseLargestEigenvectors) 
+{
+	const int N = 100;
+	tapkee::DenseMatrix random = tapkee::DenseMatrix::Random(N,N);
+	tapkee::DenseMatrix mat = random*random.transpose();
+
+	tapkee::tapkee_internal::EigendecompositionResult result = 
+		tapkee::tapkee_internal::eigendecomposition
+		(tapkee::Lobpcg, tapkee::HomogeneousCPUStrategy, tapkee::tapkee_internal::LargestEigenvalues, mat, 3);
+
+	tapkee::DenseSelfAdjointEigenSolver solver(mat);
+
+	ASSERT_EQ(3,result.second.size());
+	ASSERT_EQ(3,result.first.cols());
+	ASSERT_EQ(N,result.first.rows());
+	for (int i=0; i<3; i++)
+	{
+		ASSERT_NEAR(solver.eigenvalues()[N-3+i],result.second[i],PRECISION*solver.eigenvalues()[N-1]);
+		// check if it is an eigenvector
+		ASSERT_NEAR(0.0,(mat*result.first.col(i) - result.second[i]*result.first.col(i)).norm(),
+		            1e-6*solver.eigenvalues()[N-1]);
+	}
+}
+
+TEST(EigenDecomposition, LobpcgSparseSmallestEigenvector) 
+{
+	const int N = 50;
+	tapkee::tapkee_internal::SparseTriplets sparse_triplets;
+	for (int i=0; i<N; i++)
+		sparse_triplets.push_back(tapkee::tapkee_internal::SparseTriplet(i,i,tapkee::ScalarType(i+1)));
+
+	tapkee::SparseWeightMatrix mat(N,N);
+	mat.setFromTriplets(sparse_triplets.begin(),sparse_triplets.end());
+
+	tapkee::tapkee_internal::EigendecompositionResult result = 
+		tapkee::tapkee_internal::eigendecomposition
+		(tapkee::Lobpcg, tapkee::HomogeneousCPUStrategy, tapkee::tapkee_internal::SmallestEigenvalues, mat, 1);
+
+	ASSERT_EQ(1,result.second.size());
+	// smallest eigenvalue is 1 and it is skipped
+	ASSERT_NEAR(2,result.second[0],1e-6);
+	ASSERT_EQ(1,result.first.cols());
+	ASSERT_EQ(N,result.first.rows());
+	// check if it is an eigenvector
+	ASSERT_NEAR(0.0,(mat*result.first - result.second[0]*result.first).norm(),1e-6);
+}
+
+TEST(EigenDecomposition, DeflatedShiftInvertOperation) 
+{
+	const int N = 20;
+	// laplacian of a path graph has constant nullspace
+	tapkee::tapkee_internal::SparseTriplets sparse_triplets;
+	for (int i=0; i<N; i++)
+	{
+		sparse_triplets.push_back(tapkee::tapkee_internal::SparseTriplet(i,i,(i==0 || i==N-1) ? 1.0 : 2.0));
+		if (i>0)
+		{
+			sparse_triplets.push_back(tapkee::tapkee_internal::SparseTriplet(i,i-1,-1.0));
+			sparse_triplets.push_back(tapkee::tapkee_internal::SparseTriplet(i-1,i,-1.0));
+		}
+	}
+	tapkee::SparseWeightMatrix mat(N,N);
+	mat.setFromTriplets(sparse_triplets.begin(),sparse_triplets.end());
+	ASSERT_TRUE(tapkee::tapkee_internal::has_constant_nullspace(mat));
+
+	tapkee::DenseMatrix dense_mat = mat;
+	tapkee::DenseSelfAdjointEigenSolver solver(dense_mat);
+
+	tapkee::tapkee_internal::DeflatedSparseMatrix deflated(mat,tapkee::DenseVector::Ones(N),-1e-3);
+	tapkee::tapkee_internal::SparseDeflatedShiftInvertMatrixOperation operation(deflated);
+
+	tapkee::DenseMatrix result(N,2);
+	operation.apply(solver.eigenvectors().leftCols(2),result);
+	// nullspace is mapped to zero
+	ASSERT_NEAR(0.0,result.col(0).norm(),PRECISION);
+	// other eigenvectors are scaled by the inverse of the shifted eigenvalue
+	ASSERT_NEAR(0.0,(result.col(1) - solver.eigenvectors().col(1)/(solver.eigenvalues()[1]+1e-3)).norm(),1e-6);
+}
+
+#ifdef TAPKEE_WITH_ARPACK
+TEST(EigenDecomposition, ArpackSparseDeflatedSmallestEigenvector) 
+{
+	const int N = 50;
+	tapkee::tapkee_internal::SparseTriplets sparse_triplets;
+	for (int i=0; i<N; i++)
+	{
+		sparse_triplets.push_back(tapkee::tapkee_internal::SparseTriplet(i,i,(i==0 || i==N-1) ? 1.0 : 2.0));
+		if (i>0)
+		{
+			sparse_triplets.push_back(tapkee::tapkee_internal::SparseTriplet(i,i-1,-1.0));
+			sparse_triplets.push_back(tapkee::tapkee_internal::SparseTriplet(i-1,i,-1.0));
+		}
+	}
+	tapkee::SparseWeightMatrix mat(N,N);
+	mat.setFromTriplets(sparse_triplets.begin(),sparse_triplets.end());
+
+	tapkee::tapkee_internal::EigendecompositionResult result = 
+		tapkee::tapkee_internal::eigendecomposition
+		(tapkee::Arpack, tapkee::HomogeneousCPUStrategy, tapkee::tapkee_internal::SmallestEigenvalues, mat, 2);
+
+	tapkee::DenseMatrix dense_mat = mat;
+	tapkee::DenseSelfAdjointEigenSolver solver(dense_mat);
+
+	ASSERT_EQ(2,result.second.size());
+	for (int i=0; i<2; i++)
+	{
+		// smallest non-trivial eigenvalues in ascending order
+		ASSERT_NEAR(solver.eigenvalues()[i+1],result.second[i],PRECISION);
+		ASSERT_NEAR(0.0,(mat*result.first.col(i) - result.second[i]*result.first.col(i)).norm(),1e-6);
+	}
+}
+#endif
+
+TEST(EigenDecomposition, ChebyshevSparseSmallestEigenvectors) 
+{
+	const int N = 100;
+	// laplacian of a path graph
+	tapkee::tapkee_internal::SparseTriplets sparse_triplets;
+	for (int i=0; i<N; i++)
+	{
+		sparse_triplets.push_back(tapkee::tapkee_internal::SparseTriplet(i,i,(i==0 || i==N-1) ? 1.0 : 2.0));
+		if (i>0)
+		{
+			sparse_triplets.push_back(tapkee::tapkee_internal::SparseTriplet(i,i-1,-1.0));
+			sparse_triplets.push_back(tapkee::tapkee_internal::SparseTriplet(i-1,i,-1.0));
+		}
+	}
+	tapkee::SparseWeightMatrix mat(N,N);
+	mat.setFromTriplets(sparse_triplets.begin(),sparse_triplets.end());
+
+	tapkee::tapkee_internal::EigendecompositionResult result = 
+		tapkee::tapkee_internal::eigendecomposition
+		(tapkee::ChebyshevFilter, tapkee::HomogeneousCPUStrategy, tapkee::tapkee_internal::SmallestEigenvalues, mat, 2);
+
+	tapkee::DenseMatrix dense_mat = mat;
+	tapkee::DenseSelfAdjointEigenSolver solver(dense_mat);
+
+	ASSERT_EQ(2,result.second.size());
+	ASSERT_EQ(2,result.first.cols());
+	ASSERT_EQ(N,result.first.rows());
+	for (int i=0; i<2; i++)
+	{
+		// smallest eigenvalue is skipped
+		ASSERT_NEAR(solver.eigenvalues()[i+1],result.second[i],1e-7);
+		// check if it is an eigenvector
+		ASSERT_NEAR(0.0,(mat*result.first.col(i) - result.second[i]*result.first.col(i)).norm(),1e-6);
+	}
+}
+
+TEST(EigenDecomposition, ChebyshevDenseLargestEigenvectors) 
+{
+	const int N = 100;
+	tapkee::DenseMatrix random = tapkee::DenseMatrix::Random(N,N);
+	tapkee::DenseMatrix mat = random*random.transpose();
+
+	tapkee::tapkee_internal::EigendecompositionResult result = 
+		tapkee::tapkee_internal::eigendecomposition
+		(tapkee::ChebyshevFilter, tapkee::HomogeneousCPUStrategy, tapkee::tapkee_internal::LargestEigenvalues, mat, 2);
+
+	tapkee::DenseSelfAdjointEigenSolver solver(mat);
+
+	ASSERT_EQ(2,result.second.size());
+	for (int i=0; i<2; i++)
+	{
+		ASSERT_NEAR(solver.eigenvalues()[N-2+i],result.second[i],PRECISION*solver.eigenvalues()[N-1]);
+		// check if it is an eigenvector
+		ASSERT_NEAR(0.0,(mat*result.first.col(i) - result.second[i]*result.first.col(i)).norm(),
+		            1e-6*solver.eigenvalues()[N-1]);
+	}
+}
+
+static tapkee::SparseWeightMatrix grid_laplacian(int width, int height)
+{
+	tapkee::tapkee_internal::SparseTriplets sparse_triplets;
+	tapkee::DenseVector degrees = tapkee::DenseVector::Zero(width*height);
+	for (int i=0; i<width; i++)
+	{
+		for (int j=0; j<height; j++)
+		{
+			int node = i*height + j;
+			if (i+1<width)
+			{
+				sparse_triplets.push_back(tapkee::tapkee_internal::SparseTriplet(node,node+height,-1.0));
+				sparse_triplets.push_back(tapkee::tapkee_internal::SparseTriplet(node+height,node,-1.0));
+				degrees[node] += 1.0;
+				degrees[node+height] += 1.0;
+			}
+			if (j+1<height)
+			{
+				sparse_triplets.push_back(tapkee::tapkee_internal::SparseTriplet(node,node+1,-1.0));
+				sparse_triplets.push_back(tapkee::tapkee_internal::SparseTriplet(node+1,node,-1.0));
+				degrees[node] += 1.0;
+				degrees[node+1] += 1.0;
+			}
+		}
+	}
+	for (int i=0; i<width*height; i++)
+		sparse_triplets.push_back(tapkee::tapkee_internal::SparseTriplet(i,i,degrees[i]));
+	tapkee::SparseWeightMatrix mat(width*height,width*height);
+	mat.setFromTriplets(sparse_triplets.begin(),sparse_triplets.end());
+	return mat;
+}
+
+TEST(EigenDecomposition, SmoothedAggregationPreconditioner) 
+{
+	tapkee::SparseWeightMatrix mat = grid_laplacian(60,50);
+	const int N = mat.rows();
+
+	tapkee::tapkee_internal::SmoothedAggregationPreconditioner preconditioner(mat);
+	ASSERT_GT(preconditioner.size(),1);
+
+	// right-hand side is orthogonal to the constant nullspace
+	tapkee::DenseVector rhs = tapkee::DenseVector::Random(N);
+	rhs.array() -= rhs.mean();
+	tapkee::DenseVector solution = tapkee::DenseVector::Zero(N);
+	tapkee::DenseVector correction(N);
+	// stationary iteration converges fast if V-cycle approximates the inverse well
+	for (int i=0; i<30; i++)
+	{
+		preconditioner.apply(rhs - mat*solution,correction);
+		solution += correction;
+	}
+	ASSERT_LT((rhs - mat*solution).norm(),1e-6*rhs.norm());
+}
+
+TEST(EigenDecomposition, LobpcgPreconditionedLaplacianSmallestEigenvectors) 
+{
+	tapkee::SparseWeightMatrix mat = grid_laplacian(40,30);
+	const int N = mat.rows();
+
+	tapkee::tapkee_internal::EigendecompositionResult result = 
+		tapkee::tapkee_internal::eigendecomposition
+		(tapkee::Lobpcg, tapkee::HomogeneousCPUStrategy, tapkee::tapkee_internal::SmallestEigenvalues, mat, 3);
+
+	tapkee::DenseMatrix dense_mat = mat;
+	tapkee::DenseSelfAdjointEigenSolver solver(dense_mat);
+
+	ASSERT_EQ(3,result.second.size());
+	ASSERT_EQ(3,result.first.cols());
+	ASSERT_EQ(N,result.first.rows());
+	for (int i=0; i<3; i++)
+	{
+		// smallest eigenvalue is skipped
+		ASSERT_NEAR(solver.eigenvalues()[i+1],result.second[i],1e-7);
+		// check if it is an eigenvector
+		ASSERT_NEAR(0.0,(mat*result.first.col(i) - result.second[i]*result.first.col(i)).norm(),1e-6);
+	}
+}
+
+static tapkee::SparseWeightMatrix random_symmetric_sparse(int N, int per_row)
+{
+	tapkee::tapkee_internal::SparseTriplets sparse_triplets;
+	for (int i=0; i<N; i++)
+	{
+		sparse_triplets.push_back(tapkee::tapkee_internal::SparseTriplet(i,i,per_row+std::rand()%N));
+		for (int k=0; k<per_row; k++)
+		{
+			int j = std::rand()%N;
+			tapkee::ScalarType value = tapkee::ScalarType(std::rand())/RAND_MAX;
+			sparse_triplets.push_back(tapkee::tapkee_internal::SparseTriplet(i,j,value));
+			sparse_triplets.push_back(tapkee::tapkee_internal::SparseTriplet(j,i,value));
+		}
+	}
+	tapkee::SparseWeightMatrix mat(N,N);
+	mat.setFromTriplets(sparse_triplets.begin(),sparse_triplets.end());
+	return mat;
+}
+
+TEST(EigenDecomposition, SymmetricSparseMatrixProduct) 
+{
+	const int N = 500;
+	tapkee::SparseWeightMatrix mat = random_symmetric_sparse(N,5);
+	tapkee::tapkee_internal::SymmetricSparseMatrix symmetric(mat);
+
+	ASSERT_EQ(N,symmetric.rows());
+	ASSERT_EQ((mat.nonZeros()+N)/2,symmetric.nonZeros());
+
+	tapkee::DenseMatrix block = tapkee::DenseMatrix::Random(N,4);
+	tapkee::DenseMatrix result(N,4);
+	symmetric.multiply(block,result);
+	ASSERT_NEAR(0.0,(result - mat*block).norm(),1e-9*result.norm());
+
+	// products with vectors and views are supported as well
+	tapkee::DenseVector vector_result(N);
+	symmetric.multiply(block.col(2),vector_result);
+	ASSERT_NEAR(0.0,(vector_result - mat*block.col(2)).norm(),1e-9*vector_result.norm());
+}
+
+TEST(EigenDecomposition, SparseLargestEigenvectors) 
+{
+	const int N = 300;
+	tapkee::SparseWeightMatrix mat = random_symmetric_sparse(N,5);
+
+	tapkee::DenseMatrix dense_mat = mat;
+	tapkee::DenseSelfAdjointEigenSolver solver(dense_mat);
+
+	const tapkee::EigenMethod methods[] = { tapkee::Dense, tapkee::Lobpcg, tapkee::ChebyshevFilter };
+	for (int m=0; m<3; m++)
+	{
+		tapkee::tapkee_internal::EigendecompositionResult result = 
+			tapkee::tapkee_internal::eigendecomposition
+			(methods[m], tapkee::HomogeneousCPUStrategy, tapkee::tapkee_internal::LargestEigenvalues, mat, 2);
+
+		ASSERT_EQ(2,result.second.size());
+		for (int i=0; i<2; i++)
+		{
+			ASSERT_NEAR(solver.eigenvalues()[N-2+i],result.second[i],PRECISION*solver.eigenvalues()[N-1]);
+			// check if it is an eigenvector
+			ASSERT_NEAR(0.0,(mat*result.first.col(i) - result.second[i]*result.first.col(i)).norm(),
+			            1e-6*solver.eigenvalues()[N-1]);
+		}
+	}
+}
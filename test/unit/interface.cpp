@@ -249,3 +249,173 @@ TEST(Interface, NotEnoughMemoryMDS)
 	ASSERT_THROW(output = embed(data.begin(),data.end(),kcb,dcb,fcb,tapkee::kwargs[method=MultidimensionalScaling,eigen_method=Dense]),
 	             not_enough_memory_error);
 }
+
+TEST(Interface, EmbedIntoProvidedMatrix)
+{
+	const int N = 50;
+	tapkee::DenseMatrix X = tapkee::DenseMatrix::Random(5,N);
+
+	TapkeeOutput output;
+	ASSERT_NO_THROW(output = tapkee::initialize()
+		.withParameters((method=PCA,target_dimension=2))
+		.embedUsing(X));
+
+	// row-major buffer owned by the caller
+	std::vector<tapkee::ScalarType> buffer(N*2);
+	typedef Eigen::Matrix<tapkee::ScalarType,Eigen::Dynamic,Eigen::Dynamic,Eigen::RowMajor> RowMajorMatrix;
+	tapkee::ProjectingFunction projection;
+	ASSERT_NO_THROW(projection = tapkee::initialize()
+		.withParameters((method=PCA,target_dimension=2))
+		.embedUsing(X,Eigen::Map<RowMajorMatrix>(&buffer[0],N,2)));
+	ASSERT_TRUE(Eigen::Map<RowMajorMatrix>(&buffer[0],N,2).isApprox(output.embedding));
+	ASSERT_TRUE(projection.implementation != NULL);
+	projection.clear();
+
+	// block of a column-major matrix
+	tapkee::DenseMatrix Y = tapkee::DenseMatrix::Zero(N,4);
+	ASSERT_NO_THROW(projection = tapkee::initialize()
+		.withParameters((method=PCA,target_dimension=2))
+		.embedUsing(X,Y.rightCols(2)));
+	ASSERT_TRUE(Y.rightCols(2).isApprox(output.embedding));
+	ASSERT_TRUE(Y.leftCols(2).isZero());
+	projection.clear();
+	output.projection.clear();
+}
+
+TEST(Interface, EmbedIntoWrongSizeMatrix)
+{
+	const int N = 50;
+	tapkee::DenseMatrix X = tapkee::DenseMatrix::Random(5,N);
+
+	tapkee::DenseMatrix wrong_rows(N+1,2);
+	ASSERT_THROW(tapkee::initialize()
+		.withParameters((method=PCA,target_dimension=2))
+		.embedUsing(X,wrong_rows), wrong_parameter_error);
+
+	tapkee::DenseMatrix wrong_cols(N,3);
+	ASSERT_THROW(tapkee::initialize()
+		.withParameters((method=PCA,target_dimension=2))
+		.embedUsing(X,wrong_cols), wrong_parameter_error);
+}
+
+TEST(Interface, TapkeeOutputCopy)
+{
+	tapkee::DenseMatrix X = tapkee::DenseMatrix::Random(5,50);
+
+	TapkeeOutput output = tapkee::initialize()
+		.withParameters((method=PCA,target_dimension=2))
+		.embedUsing(X);
+	const TapkeeOutput& const_output = output;
+	TapkeeOutput copy(const_output);
+
+	// copying leaves the original untouched
+	ASSERT_EQ(50,output.embedding.rows());
+	ASSERT_TRUE(copy.embedding.isApprox(output.embedding));
+	// and shares the projecting function
+	ASSERT_EQ(output.projection.implementation,copy.projection.implementation);
+}
+
+struct counted_projection : public tapkee::ProjectionImplementation
+{
+	counted_projection(int* d) : destroyed(d) { }
+	virtual ~counted_projection() { ++(*destroyed); }
+	virtual tapkee::DenseVector project(const tapkee::DenseVector& vec) { return 2*vec; }
+	int* destroyed;
+};
+
+TEST(Interface, SharedProjectingFunction)
+{
+	int destroyed = 0;
+	{
+		tapkee::ProjectingFunction projection(new counted_projection(&destroyed));
+		std::vector<tapkee::ProjectingFunction> copies(16,projection);
+		projection.clear();
+		ASSERT_EQ(0,destroyed);
+
+		const int n = 1000;
+		tapkee::DenseMatrix projected(3,n);
+#pragma omp parallel for
+		for (int i=0; i<n; ++i)
+		{
+			tapkee::ProjectingFunction local = copies[i%copies.size()];
+			projected.col(i) = local(tapkee::DenseVector::Constant(3,i));
+		}
+		for (int i=0; i<n; ++i)
+			ASSERT_TRUE(projected.col(i).isApprox(tapkee::DenseVector::Constant(3,2.0*i)));
+		ASSERT_EQ(0,destroyed);
+	}
+	// destroyed once with the last copy
+	ASSERT_EQ(1,destroyed);
+}
+
+TEST(Interface, EmbedUsingMappedData)
+{
+	const int N = 40;
+	const int D = 4;
+	tapkee::DenseMatrix X = tapkee::DenseMatrix::Random(D,N);
+
+	typedef Eigen::Matrix<tapkee::ScalarType,Eigen::Dynamic,Eigen::Dynamic,Eigen::RowMajor> RowMajorMatrix;
+	// points in rows of a row-major buffer
+	RowMajorMatrix rows = X.transpose();
+	// points in columns of a padded buffer
+	tapkee::DenseMatrix padded = tapkee::DenseMatrix::Zero(D+3,N);
+	padded.topRows(D) = X;
+	Eigen::Map<const tapkee::DenseMatrix,0,Eigen::OuterStride<> > strided(padded.data(),D,N,Eigen::OuterStride<>(D+3));
+
+	const tapkee::DimensionReductionMethod methods[] = {PCA, KernelPCA, Isomap};
+	for (int m=0; m<3; ++m)
+	{
+		tapkee::ParametersSet parameters = (method=methods[m],target_dimension=2,num_neighbors=10,eigen_method=Dense);
+		TapkeeOutput expected = tapkee::initialize().withParameters(parameters).embedUsing(X);
+
+		TapkeeOutput output;
+		ASSERT_NO_THROW(output = tapkee::initialize().withParameters(parameters)
+			.embedUsingRowwise(Eigen::Map<const RowMajorMatrix>(rows.data(),N,D)));
+		ASSERT_TRUE(output.embedding.isApprox(expected.embedding));
+
+		ASSERT_NO_THROW(output = tapkee::initialize().withParameters(parameters).embedUsing(strided));
+		ASSERT_TRUE(output.embedding.isApprox(expected.embedding));
+
+		ASSERT_NO_THROW(output = tapkee::initialize().withParameters(parameters).embedUsing(padded.topRows(D)));
+		ASSERT_TRUE(output.embedding.isApprox(expected.embedding));
+	}
+}
+
+TEST(Interface, EmbedUsingSparseData)
+{
+	const int N = 40;
+	const int D = 50;
+	// sparse points with about 10% of non-zero coordinates
+	tapkee::DenseMatrix X = tapkee::DenseMatrix::Random(D,N);
+	X = (tapkee::DenseMatrix::Random(D,N).array() > 0.8).select(X,0.0);
+	tapkee::SparseMatrix sparse = X.sparseView();
+
+	tapkee::eigen_sparse_distance_callback sparse_dcb(sparse);
+	tapkee::eigen_distance_callback dcb(X);
+	tapkee::eigen_sparse_kernel_callback sparse_kcb(sparse);
+	tapkee::eigen_kernel_callback kcb(X);
+	for (int i=0; i<N; ++i)
+	{
+		for (int j=0; j<N; ++j)
+		{
+			ASSERT_NEAR(dcb.distance(i,j),sparse_dcb.distance(i,j),1e-9);
+			ASSERT_NEAR(kcb.kernel(i,j),sparse_kcb.kernel(i,j),1e-9);
+			ASSERT_GT(sparse_dcb.distance_bounded(i,j,0.5*dcb.distance(i,j)),0.5*dcb.distance(i,j)-1e-9);
+		}
+	}
+
+	const tapkee::DimensionReductionMethod methods[] = {PCA, KernelPCA, MultidimensionalScaling, RandomProjection};
+	for (int m=0; m<4; ++m)
+	{
+		tapkee::ParametersSet parameters = (method=methods[m],target_dimension=2,num_neighbors=10,eigen_method=Dense);
+		TapkeeOutput output;
+		ASSERT_NO_THROW(output = tapkee::initialize().withParameters(parameters).embedUsing(sparse));
+		ASSERT_EQ(N,output.embedding.rows());
+		ASSERT_EQ(2,output.embedding.cols());
+		if (methods[m] != RandomProjection)
+		{
+			TapkeeOutput expected = tapkee::initialize().withParameters(parameters).embedUsing(X);
+			ASSERT_TRUE(output.embedding.isApprox(expected.embedding));
+		}
+	}
+}
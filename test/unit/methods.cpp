@@ -10,6 +10,7 @@
 #include <vector>
 #include <algorithm>
 #include <set>
+#include <cmath>
 
 using namespace tapkee;
 
@@ -60,6 +61,39 @@ TEST(Methods,LaplacianEigenmapsSmokeTest)
 	smoketest(LaplacianEigenmaps);
 }
 
+TEST(Methods,LandmarkLaplacianEigenmapsSmokeTest)
+{
+	smoketest(LandmarkLaplacianEigenmaps);
+}
+
+TEST(Methods,LandmarkLaplacianEigenmapsProjection)
+{
+	const int N = 200;
+	DenseMatrix X = swissroll(N);
+	tapkee::eigen_kernel_callback kcb(X);
+	tapkee::eigen_distance_callback dcb(X);
+	tapkee::eigen_features_callback fcb(X);
+	std::vector<int> data(N);
+	for (int i=0; i<N; ++i) data[i] = i;
+
+	TapkeeOutput result;
+	ASSERT_NO_THROW(result = embed(data.begin(), data.end(), kcb, dcb, fcb,
+		(method=LandmarkLaplacianEigenmaps,eigen_method=Dense,target_dimension=2,
+		 num_neighbors=5,landmark_ratio=0.2,gaussian_kernel_width=10.0)));
+	ASSERT_EQ(2,result.embedding.cols());
+	ASSERT_EQ(N,result.embedding.rows());
+	ASSERT_TRUE(result.projection.implementation != NULL);
+
+	// trivial constant eigenvector is dropped
+	for (int j=0; j<2; ++j)
+		ASSERT_GT((result.embedding.col(j).array() - result.embedding.col(j).mean()).matrix().norm(), 1e-6);
+
+	// training vectors are mapped exactly as they were embedded
+	for (int i=0; i<N; i+=10)
+		ASSERT_TRUE(result.projection(X.col(i)).isApprox(result.embedding.row(i).transpose(),1e-6));
+	result.projection.clear();
+}
+
 TEST(Methods,LocalityPreservingProjectionsSmokeTest)
 {
 	smoketest(LocalityPreservingProjections);
@@ -70,6 +104,34 @@ TEST(Methods,DiffusionMapSmokeTest)
 	smoketest(DiffusionMap);
 }
 
+TEST(Methods,DiffusionMapNystrom)
+{
+	const int N = 50;
+	DenseMatrix X = swissroll(N);
+	tapkee::eigen_kernel_callback kcb(X);
+	tapkee::eigen_distance_callback dcb(X);
+	tapkee::eigen_features_callback fcb(X);
+	std::vector<int> data(N);
+	for (int i=0; i<N; ++i) data[i] = i;
+
+	TapkeeOutput result;
+	ASSERT_NO_THROW(result = embed(data.begin(), data.end(), kcb, dcb, fcb,
+		(method=DiffusionMap,eigen_method=Dense,target_dimension=2,gaussian_kernel_width=10.0,
+		 diffusion_map_nystrom=true,landmark_ratio=0.3)));
+	ASSERT_EQ(2,result.embedding.cols());
+	ASSERT_EQ(N,result.embedding.rows());
+
+	// with all vectors used as landmarks the approximation is exact
+	TapkeeOutput exact_result, nystrom_result;
+	ASSERT_NO_THROW(exact_result = embed(data.begin(), data.end(), kcb, dcb, fcb,
+		(method=DiffusionMap,eigen_method=Dense,target_dimension=2,gaussian_kernel_width=10.0)));
+	ASSERT_NO_THROW(nystrom_result = embed(data.begin(), data.end(), kcb, dcb, fcb,
+		(method=DiffusionMap,eigen_method=Dense,target_dimension=2,gaussian_kernel_width=10.0,
+		 diffusion_map_nystrom=true,landmark_ratio=1.0)));
+	for (int j=0; j<2; ++j)
+		ASSERT_NEAR(1.0,std::abs(exact_result.embedding.col(j).dot(nystrom_result.embedding.col(j))),1e-6);
+}
+
 TEST(Methods,IsomapSmokeTest)
 {
 	smoketest(Isomap);
@@ -119,3 +181,189 @@ TEST(Methods,tDistributedStochasticNeighborEmbeddingSmokeTest)
 {
 	smoketest(tDistributedStochasticNeighborEmbedding);
 }
+
+TEST(Methods,tDistributedStochasticNeighborEmbeddingProjection)
+{
+	const int N = 100;
+	DenseMatrix X = swissroll(N);
+	tapkee::eigen_kernel_callback kcb(X);
+	tapkee::eigen_distance_callback dcb(X);
+	tapkee::eigen_features_callback fcb(X);
+	std::vector<int> data(N);
+	for (int i=0; i<N; ++i) data[i] = i;
+
+	TapkeeOutput result;
+	ASSERT_NO_THROW(result = embed(data.begin(), data.end(), kcb, dcb, fcb,
+		(method=tDistributedStochasticNeighborEmbedding,target_dimension=2,sne_perplexity=10.0)));
+	ASSERT_TRUE(result.projection.implementation != NULL);
+
+	tapkee::tapkee_internal::TSNEProjectionImplementation* implementation = 
+		dynamic_cast<tapkee::tapkee_internal::TSNEProjectionImplementation*>(result.projection.implementation);
+	ASSERT_TRUE(implementation != NULL);
+	DenseMatrix projected = implementation->project_batch(X);
+	ASSERT_EQ(N,projected.rows());
+	ASSERT_EQ(2,projected.cols());
+
+	ScalarType spread = (result.embedding.rowwise() - result.embedding.colwise().mean()).norm()/sqrt(N);
+	for (int i=0; i<N; ++i)
+	{
+		// batch projection matches projection of single vectors
+		ASSERT_TRUE(projected.row(i).transpose().isApprox(result.projection(X.col(i))));
+		// training vectors are placed close to their embedding
+		ASSERT_LT((projected.row(i) - result.embedding.row(i)).norm(), 0.2*spread);
+	}
+	result.projection.clear();
+}
+
+TEST(Methods,tDistributedStochasticNeighborEmbeddingSymmetrization)
+{
+	const int N = 300;
+	const int K = 7;
+	int* row_P = (int*) malloc((N + 1) * sizeof(int));
+	int* col_P = (int*) malloc(N * K * sizeof(int));
+	ScalarType* val_P = (ScalarType*) malloc(N * K * sizeof(ScalarType));
+	DenseMatrix P = DenseMatrix::Zero(N,N);
+	row_P[0] = 0;
+	for (int n=0; n<N; ++n)
+	{
+		row_P[n+1] = row_P[n] + K;
+		// distinct columns in arbitrary order, some of edges are mutual
+		for (int k=0; k<K; ++k)
+		{
+			int col = (n + 1 + (k*37 + n) % (N-1)) % N;
+			while (P(n,col) != 0.0 || col == n)
+				col = (col + 1) % N;
+			col_P[row_P[n]+k] = col;
+			val_P[row_P[n]+k] = tapkee::uniform_random() + 0.1;
+			P(n,col) = val_P[row_P[n]+k];
+		}
+	}
+
+	tsne::TSNE tsne;
+	tsne.symmetrizeMatrix(&row_P,&col_P,&val_P,N);
+
+	DenseMatrix symmetric_P = DenseMatrix::Zero(N,N);
+	for (int n=0; n<N; ++n)
+	{
+		for (int i=row_P[n]; i<row_P[n+1]; ++i)
+		{
+			// no duplicate entries and rows are sorted
+			ASSERT_EQ(0.0,symmetric_P(n,col_P[i]));
+			if (i > row_P[n])
+				ASSERT_LT(col_P[i-1],col_P[i]);
+			symmetric_P(n,col_P[i]) = val_P[i];
+		}
+	}
+	ASSERT_TRUE(symmetric_P.isApprox(0.5*(P + P.transpose())));
+	free(row_P);
+	free(col_P);
+	free(val_P);
+}
+
+TEST(Methods,CollapseDuplicates)
+{
+	const int N = 50;
+	const int n_duplicates = 30;
+	DenseMatrix X = swissroll(N);
+	DenseMatrix X_duplicated(X.rows(),N+n_duplicates);
+	X_duplicated << X, X.leftCols(n_duplicates);
+
+	tapkee::eigen_kernel_callback kcb(X_duplicated);
+	tapkee::eigen_distance_callback dcb(X_duplicated);
+	tapkee::eigen_features_callback fcb(X_duplicated);
+	std::vector<int> data(N+n_duplicates);
+	for (int i=0; i<N+n_duplicates; ++i) data[i] = i;
+
+	TapkeeOutput result;
+	ASSERT_NO_THROW(result = embed(data.begin(), data.end(), kcb, dcb, fcb,
+		(method=Isomap,eigen_method=Dense,target_dimension=2,num_neighbors=N/5,collapse_duplicates=true)));
+	ASSERT_EQ(N+n_duplicates,result.embedding.rows());
+
+	TapkeeOutput unique_result;
+	ASSERT_NO_THROW(unique_result = embed(data.begin(), data.begin()+N, kcb, dcb, fcb,
+		(method=Isomap,eigen_method=Dense,target_dimension=2,num_neighbors=N/5)));
+
+	// distinct vectors are embedded just like without duplicates
+	ASSERT_TRUE(result.embedding.topRows(N).isApprox(unique_result.embedding));
+	// and duplicates share embedding of their representatives
+	ASSERT_TRUE(result.embedding.bottomRows(n_duplicates).isApprox(result.embedding.topRows(n_duplicates)));
+}
+
+TEST(Methods,SampleAndExtendProjection)
+{
+	const int N = 100;
+	DenseMatrix X = swissroll(N);
+	tapkee::eigen_kernel_callback kcb(X);
+	tapkee::eigen_distance_callback dcb(X);
+	tapkee::eigen_features_callback fcb(X);
+	std::vector<int> data(N);
+	for (int i=0; i<N; ++i) data[i] = i;
+
+	TapkeeOutput result;
+	ASSERT_NO_THROW(result = embed(data.begin(), data.end(), kcb, dcb, fcb,
+		(method=PCA,target_dimension=2,sample_size=N/4)));
+	ASSERT_EQ(2,result.embedding.cols());
+	ASSERT_EQ(N,result.embedding.rows());
+
+	// vectors out of the sample are projected with the projecting function
+	for (int i=0; i<N; ++i)
+		ASSERT_TRUE(result.embedding.row(i).transpose().isApprox(result.projection(X.col(i)),1e-6));
+	result.projection.clear();
+}
+
+TEST(Methods,SampleAndExtendInterpolation)
+{
+	const int N = 100;
+	DenseMatrix X = swissroll(N);
+	tapkee::eigen_kernel_callback kcb(X);
+	tapkee::eigen_distance_callback dcb(X);
+	tapkee::eigen_features_callback fcb(X);
+	std::vector<int> data(N);
+	for (int i=0; i<N; ++i) data[i] = i;
+
+	TapkeeOutput result;
+	ASSERT_NO_THROW(result = embed(data.begin(), data.end(), kcb, dcb, fcb,
+		(method=Isomap,eigen_method=Dense,target_dimension=2,num_neighbors=10,
+		 sample_size=N/2,sampling_method=FarthestPointSampling)));
+	ASSERT_EQ(2,result.embedding.cols());
+	ASSERT_EQ(N,result.embedding.rows());
+	ASSERT_TRUE(result.embedding.allFinite());
+
+	// each of sampled vectors is embedded exactly once, the rest is interpolated
+	// from their embedding so there should be exactly N/2 distinct rows at least
+	std::set<std::pair<ScalarType,ScalarType> > rows;
+	for (int i=0; i<N; ++i)
+		rows.insert(std::make_pair(result.embedding(i,0),result.embedding(i,1)));
+	ASSERT_GE(static_cast<int>(rows.size()),N/2);
+}
+
+TEST(Methods,PrecomputedNeighbors)
+{
+	const int N = 100;
+	DenseMatrix X = swissroll(N);
+	tapkee::eigen_kernel_callback kcb(X);
+	tapkee::eigen_distance_callback dcb(X);
+	tapkee::eigen_features_callback fcb(X);
+	std::vector<int> data(N);
+	for (int i=0; i<N; ++i) data[i] = i;
+
+	// neighbors computed for the larger number of neighbors are truncated
+	tapkee_internal::Neighbors neighbors = tapkee_internal::find_neighbors(Brute,data.begin(),data.end(),
+		tapkee_internal::PlainDistance<std::vector<int>::iterator,tapkee::eigen_distance_callback>(dcb),20,false);
+	tapkee_internal::sort_neighbors(data.begin(),dcb,neighbors);
+	const tapkee_internal::Neighbors* precomputed = &neighbors;
+
+	TapkeeOutput result;
+	ASSERT_NO_THROW(result = embed(data.begin(), data.end(), kcb, dcb, fcb,
+		(method=Isomap,eigen_method=Dense,target_dimension=2,num_neighbors=10)));
+	TapkeeOutput precomputed_result;
+	ASSERT_NO_THROW(precomputed_result = embed(data.begin(), data.end(), kcb, dcb, fcb,
+		(method=Isomap,eigen_method=Dense,target_dimension=2,num_neighbors=10,
+		 precomputed_neighbors=precomputed)));
+	ASSERT_TRUE(result.embedding.isApprox(precomputed_result.embedding,1e-6));
+
+	// there are not enough precomputed neighbors
+	ASSERT_THROW(embed(data.begin(), data.end(), kcb, dcb, fcb,
+		(method=Isomap,eigen_method=Dense,target_dimension=2,num_neighbors=30,
+		 precomputed_neighbors=precomputed)), wrong_parameter_error);
+}
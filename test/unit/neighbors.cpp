@@ -8,6 +8,7 @@
 #include <vector>
 #include <algorithm>
 #include <set>
+#include <limits>
 
 #define TOLERANCE 1e-9
 
@@ -156,3 +157,151 @@ TEST(Neighbors,CoverTreeKernelNeighbors)
 			ASSERT_NE(neighbors_set.find(floats[i+j+1]),neighbors_set.end());
 	}
 }
+
+TEST(Neighbors,KdTreeFeaturesNeighbors)
+{
+	typedef std::vector<float> Floats;
+	const int N = 100;
+	const int k = 10;
+
+	Floats floats;
+	for (int i=0;i<N;i++) 
+		floats.push_back(float(i));
+
+	float_distance_callback fdc;
+	float_features_callback ffc;
+	tapkee::tapkee_internal::Neighbors neighbors = 
+		tapkee::tapkee_internal::find_neighbors(tapkee::KdTree, floats.begin(), floats.end(),
+				tapkee::tapkee_internal::PlainDistance<Floats::iterator,float_distance_callback>(fdc), 
+				ffc, 1, k, true);
+
+	for (int i=0;i<N;i++)
+	{
+		// total number of found neighbors is k
+		ASSERT_EQ(neighbors[i].size(),k);
+		std::set<float> neighbors_set;
+		for (int j=0;j<k;j++) 
+			neighbors_set.insert(neighbors[i][j]);
+		// there are no repeated values
+		ASSERT_EQ(neighbors_set.size(),k);
+		// the vector is not a neighbor of itself
+		ASSERT_EQ(neighbors_set.find(floats[i]),neighbors_set.end());
+		// check neighbors
+		int k_left = std::min(i,k/2);
+		int k_right = std::min(N-i-1,k/2);
+		for (int j=0; j<k_left; j++) 
+			ASSERT_NE(neighbors_set.find(floats[i-j-1]),neighbors_set.end());
+		for (int j=0; j<k_right; j++) 
+			ASSERT_NE(neighbors_set.find(floats[i+j+1]),neighbors_set.end());
+	}
+}
+
+TEST(Neighbors,FeaturesTreesMatchBruteForce)
+{
+	const int N = 2000;
+	const int k = 7;
+	tapkee::DenseMatrix points = tapkee::DenseMatrix::Random(3,N);
+	std::vector<tapkee::IndexType> indices;
+	for (int i=0;i<N;i++)
+		indices.push_back(i);
+
+	tapkee::eigen_distance_callback dcb(points);
+	tapkee::eigen_features_callback fcb(points);
+	typedef tapkee::tapkee_internal::PlainDistance<std::vector<tapkee::IndexType>::iterator,
+	                                               tapkee::eigen_distance_callback> Distance;
+
+	tapkee::tapkee_internal::Neighbors brute = 
+		tapkee::tapkee_internal::find_neighbors(tapkee::Brute, indices.begin(), indices.end(), Distance(dcb), k, false);
+
+	const tapkee::NeighborsMethod methods[] = { tapkee::KdTree, tapkee::BallTree };
+	for (int m=0; m<2; m++)
+	{
+		tapkee::tapkee_internal::Neighbors neighbors = 
+			tapkee::tapkee_internal::find_neighbors(methods[m], indices.begin(), indices.end(), Distance(dcb),
+					fcb, 3, k, false);
+		ASSERT_EQ(N,neighbors.size());
+		for (int i=0;i<N;i++)
+		{
+			ASSERT_EQ(k,neighbors[i].size());
+			std::set<tapkee::IndexType> expected(brute[i].begin(),brute[i].end());
+			std::set<tapkee::IndexType> found(neighbors[i].begin(),neighbors[i].end());
+			ASSERT_EQ(expected,found);
+		}
+	}
+}
+
+TEST(Neighbors,CoverTreeMatchesBruteForce)
+{
+	const int N = 2000;
+	const int k = 7;
+	tapkee::DenseMatrix points = tapkee::DenseMatrix::Random(3,N);
+	std::vector<tapkee::IndexType> indices;
+	for (int i=0;i<N;i++)
+		indices.push_back(i);
+
+	tapkee::eigen_distance_callback dcb(points);
+	typedef tapkee::tapkee_internal::PlainDistance<std::vector<tapkee::IndexType>::iterator,
+	                                               tapkee::eigen_distance_callback> Distance;
+
+	tapkee::tapkee_internal::Neighbors brute = 
+		tapkee::tapkee_internal::find_neighbors(tapkee::Brute, indices.begin(), indices.end(), Distance(dcb), k, false);
+	tapkee::tapkee_internal::Neighbors neighbors = 
+		tapkee::tapkee_internal::find_neighbors(tapkee::CoverTree, indices.begin(), indices.end(), Distance(dcb), k, false);
+
+	ASSERT_EQ(N,neighbors.size());
+	for (int i=0;i<N;i++)
+	{
+		ASSERT_EQ(k,neighbors[i].size());
+		std::set<tapkee::IndexType> expected(brute[i].begin(),brute[i].end());
+		std::set<tapkee::IndexType> found(neighbors[i].begin(),neighbors[i].end());
+		ASSERT_EQ(expected,found);
+	}
+}
+
+TEST(Neighbors,BoundedEuclideanDistance)
+{
+	ASSERT_TRUE(tapkee::has_bounded_distance<tapkee::eigen_distance_callback>::value);
+	ASSERT_FALSE(tapkee::has_bounded_distance<float_distance_callback>::value);
+
+	tapkee::DenseMatrix points = tapkee::DenseMatrix::Random(100,2);
+	tapkee::eigen_distance_callback dcb(points);
+	tapkee::ScalarType distance = dcb.distance(0,1);
+	// the exact distance is returned when it doesn't exceed the bound
+	ASSERT_NEAR(distance,dcb.distance_bounded(0,1,distance+1e-6),TOLERANCE);
+	ASSERT_NEAR(distance,dcb.distance_bounded(0,1,std::numeric_limits<tapkee::ScalarType>::max()),TOLERANCE);
+	// and anything larger than the bound otherwise
+	ASSERT_GT(dcb.distance_bounded(0,1,0.5*distance),0.5*distance);
+}
+
+TEST(Neighbors,BoundedDistanceTreesMatchBruteForce)
+{
+	const int N = 1000;
+	const int k = 5;
+	tapkee::DenseMatrix points = tapkee::DenseMatrix::Random(40,N);
+	std::vector<tapkee::IndexType> indices;
+	for (int i=0;i<N;i++)
+		indices.push_back(i);
+
+	tapkee::eigen_distance_callback dcb(points);
+	tapkee::eigen_features_callback fcb(points);
+	typedef tapkee::tapkee_internal::PlainDistance<std::vector<tapkee::IndexType>::iterator,
+	                                               tapkee::eigen_distance_callback> Distance;
+
+	tapkee::tapkee_internal::Neighbors brute = 
+		tapkee::tapkee_internal::find_neighbors(tapkee::Brute, indices.begin(), indices.end(), Distance(dcb), k, false);
+
+	const tapkee::NeighborsMethod methods[] = { tapkee::VpTree, tapkee::CoverTree, tapkee::KdTree, tapkee::BallTree };
+	for (int m=0; m<4; m++)
+	{
+		tapkee::tapkee_internal::Neighbors neighbors = 
+			tapkee::tapkee_internal::find_neighbors(methods[m], indices.begin(), indices.end(), Distance(dcb),
+					fcb, 40, k, false);
+		ASSERT_EQ(N,neighbors.size());
+		for (int i=0;i<N;i++)
+		{
+			std::set<tapkee::IndexType> expected(brute[i].begin(),brute[i].end());
+			std::set<tapkee::IndexType> found(neighbors[i].begin(),neighbors[i].end());
+			ASSERT_EQ(expected,found);
+		}
+	}
+}